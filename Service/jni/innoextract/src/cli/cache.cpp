@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "cli/cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "crypto/xxhash.hpp"
+#include "setup/version.hpp"
+#include "util/endian.hpp"
+#include "util/fstream.hpp"
+#include "util/load.hpp"
+#include "util/log.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const char cache_magic[] = "innoextract header cache 1";
+
+/*!
+ * Hash the stored setup headers, starting with the version identifier.
+ *
+ * \return \c false if the region could not be read.
+ */
+bool hash_headers(std::istream & is, boost::uint32_t offset, boost::uint64_t size,
+                  boost::uint64_t & hash) {
+	
+	is.clear();
+	is.seekg(offset);
+	
+	crypto::xxh64 hasher;
+	hasher.init();
+	
+	char buffer[64 * 1024];
+	while(size) {
+		size_t n = size_t(std::min(size, boost::uint64_t(sizeof(buffer))));
+		if(!is.read(buffer, std::streamsize(n))) {
+			return false;
+		}
+		hasher.update(buffer, n);
+		size -= n;
+	}
+	
+	hash = hasher.finalize();
+	return true;
+}
+
+template <class T>
+void put(std::ostream & os, T value) {
+	char buffer[sizeof(T)];
+	util::little_endian::store(value, buffer);
+	os.write(buffer, std::streamsize(sizeof(buffer)));
+}
+
+void put(std::ostream & os, const std::string & data) {
+	put(os, boost::uint32_t(data.size()));
+	os.write(data.data(), std::streamsize(data.size()));
+}
+
+} // anonymous namespace
+
+header_cache::header_cache(const fs::path & dir, const fs::path & installer,
+                           boost::uint32_t header_offset)
+	: dir_(dir), size_(0), mtime_(0), header_offset_(header_offset) {
+	
+	boost::system::error_code ec;
+	size_ = fs::file_size(installer, ec);
+	if(!ec) {
+		mtime_ = boost::int64_t(fs::last_write_time(installer, ec));
+	}
+	if(ec) {
+		// Without a reliable identity the cache can't be used
+		return;
+	}
+	
+	char key[8 + 8 + 4];
+	util::little_endian::store(size_, key);
+	util::little_endian::store(boost::uint64_t(mtime_), key + 8);
+	util::little_endian::store(header_offset_, key + 16);
+	crypto::xxh64 hasher;
+	hasher.init();
+	hasher.update(key, sizeof(key));
+	
+	std::ostringstream oss;
+	oss << std::hex << std::setfill('0') << std::setw(16) << hasher.finalize() << ".hdr";
+	path_ = dir_ / oss.str();
+}
+
+bool header_cache::load(std::istream & is, setup::info & info,
+                        setup::info::entry_types entries) {
+	
+	if(path_.empty()) {
+		return false;
+	}
+	
+	util::ifstream ifs(path_, std::ios_base::in | std::ios_base::binary);
+	if(!ifs.is_open()) {
+		return false;
+	}
+	
+	char magic[sizeof(cache_magic) - 1];
+	if(!ifs.read(magic, std::streamsize(sizeof(magic)))
+	   || std::memcmp(magic, cache_magic, sizeof(magic)) != 0) {
+		return false;
+	}
+	
+	boost::uint64_t size = util::load<boost::uint64_t>(ifs);
+	boost::int64_t mtime = util::load<boost::int64_t>(ifs);
+	boost::uint32_t header_offset = util::load<boost::uint32_t>(ifs);
+	boost::uint64_t headers_size = util::load<boost::uint64_t>(ifs);
+	boost::uint64_t headers_hash = util::load<boost::uint64_t>(ifs);
+	if(ifs.fail() || size != size_ || mtime != mtime_ || header_offset != header_offset_) {
+		return false;
+	}
+	
+	boost::uint64_t hash;
+	if(!hash_headers(is, header_offset_, headers_size, hash) || hash != headers_hash) {
+		return false;
+	}
+	
+	setup::version version;
+	version.value = util::load<boost::uint32_t>(ifs);
+	version.bits = util::load<boost::uint8_t>(ifs);
+	version.unicode = util::load_bool(ifs);
+	version.known = util::load_bool(ifs);
+	
+	std::string primary, secondary;
+	util::binary_string::load(ifs, primary);
+	util::binary_string::load(ifs, secondary);
+	if(ifs.fail()) {
+		return false;
+	}
+	
+	try {
+		info.load(primary, secondary, entries, version);
+	} catch(const std::ios_base::failure & e) {
+		log_warning << "Ignoring invalid header cache " << path_ << ": " << e.what();
+		return false;
+	}
+	info.version = version;
+	
+	return true;
+}
+
+void header_cache::store(std::istream & is, const setup::info & info,
+                         const std::string & primary, const std::string & secondary) {
+	
+	if(path_.empty()) {
+		return;
+	}
+	
+	std::streampos end = is.tellg();
+	if(end < std::streampos(header_offset_)) {
+		return;
+	}
+	boost::uint64_t headers_size = boost::uint64_t(end) - header_offset_;
+	boost::uint64_t headers_hash;
+	if(!hash_headers(is, header_offset_, headers_size, headers_hash)) {
+		return;
+	}
+	
+	boost::system::error_code ec;
+	fs::create_directories(dir_, ec);
+	
+	// Write to a temporary file first so that other processes never see partial entries
+	fs::path temp = dir_ / (path_.filename().string() + ".tmp");
+	{
+		util::ofstream ofs(temp, std::ios_base::out | std::ios_base::binary
+		                         | std::ios_base::trunc);
+		if(!ofs.is_open()) {
+			log_warning << "Could not write header cache " << path_;
+			return;
+		}
+		
+		ofs.write(cache_magic, std::streamsize(sizeof(cache_magic) - 1));
+		put(ofs, size_);
+		put(ofs, mtime_);
+		put(ofs, header_offset_);
+		put(ofs, headers_size);
+		put(ofs, headers_hash);
+		
+		put(ofs, boost::uint32_t(info.version.value));
+		put(ofs, boost::uint8_t(info.version.bits));
+		put(ofs, boost::uint8_t(info.version.unicode));
+		put(ofs, boost::uint8_t(info.version.known));
+		
+		put(ofs, primary);
+		put(ofs, secondary);
+		
+		ofs.close();
+		if(ofs.fail()) {
+			log_warning << "Could not write header cache " << path_;
+			fs::remove(temp, ec);
+			return;
+		}
+	}
+	
+	fs::rename(temp, path_, ec);
+	if(ec) {
+		log_warning << "Could not write header cache " << path_;
+		fs::remove(temp, ec);
+	}
+}
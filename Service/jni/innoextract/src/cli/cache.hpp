@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Cache of decompressed setup headers shared between invocations.
+ */
+#ifndef INNOEXTRACT_CLI_CACHE_HPP
+#define INNOEXTRACT_CLI_CACHE_HPP
+
+#include <istream>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "setup/info.hpp"
+
+/*!
+ * On-disk cache of the decompressed setup header blocks for one installer.
+ *
+ * Entries are tied to the size and modification time of the installer and to a hash of
+ * the compressed header region, so a cached entry is never used for a different or
+ * modified installer. Cached headers still need to be parsed, but that is cheap compared
+ * to decompressing them.
+ */
+class header_cache : private boost::noncopyable {
+	
+	boost::filesystem::path dir_;
+	boost::filesystem::path path_;
+	
+	boost::uint64_t size_;
+	boost::int64_t mtime_;
+	boost::uint32_t header_offset_;
+	
+public:
+	
+	/*!
+	 * \param dir           Directory containing the cache files.
+	 * \param installer     The main setup file.
+	 * \param header_offset Position of the setup headers given by
+	 *                      \ref loader::offsets::header_offset.
+	 */
+	header_cache(const boost::filesystem::path & dir, const boost::filesystem::path & installer,
+	             boost::uint32_t header_offset);
+	
+	/*!
+	 * Load setup headers from the cache.
+	 *
+	 * \param is      Input stream for the installer, used to verify the header region.
+	 * \param info    Receives the headers and the setup data version.
+	 * \param entries What kinds of entries to load.
+	 *
+	 * \return \c true if the installer has a valid cache entry and the headers were loaded.
+	 *         Otherwise the headers need to be loaded from the installer.
+	 */
+	bool load(std::istream & is, setup::info & info, setup::info::entry_types entries);
+	
+	/*!
+	 * Store the headers of the installer in the cache.
+	 *
+	 * Problems writing the cache are reported as warnings.
+	 *
+	 * \param is        Input stream for the installer, positioned after the header blocks.
+	 * \param info      The loaded headers.
+	 * \param primary   Contents of the first header block stream.
+	 * \param secondary Contents of the second header block stream.
+	 */
+	void store(std::istream & is, const setup::info & info,
+	           const std::string & primary, const std::string & secondary);
+	
+};
+
+#endif // INNOEXTRACT_CLI_CACHE_HPP
@@ -84,12 +84,12 @@ static void print(std::ostream & os, const setup::windows_version_range & winver
 static void print(std::ostream & os, const setup::item & item,
                  const setup::header & header) {
 	
-	os << if_not_empty("  Componenets", item.components);
-	os << if_not_empty("  Tasks", item.tasks);
-	os << if_not_empty("  Languages", item.languages);
-	os << if_not_empty("  Check", item.check);
-	os << if_not_empty("  After install", item.after_install);
-	os << if_not_empty("  Before install", item.before_install);
+	os << if_not_empty("  Componenets", item.components.str());
+	os << if_not_empty("  Tasks", item.tasks.str());
+	os << if_not_empty("  Languages", item.languages.str());
+	os << if_not_empty("  Check", item.check.str());
+	os << if_not_empty("  After install", item.after_install.str());
+	os << if_not_empty("  Before install", item.before_install.str());
 	
 	print(os, item.winver, header);
 }
@@ -233,9 +233,9 @@ static void print_entry(const setup::info & info, size_t i,
 	}
 	std::cout  << '\n';
 	
-	std::cout << if_not_empty("  Source", entry.source);
-	std::cout << if_not_empty("  Install font name", entry.install_font_name);
-	std::cout << if_not_empty("  Strong assembly name", entry.strong_assembly_name);
+	std::cout << if_not_empty("  Source", entry.source.str());
+	std::cout << if_not_empty("  Install font name", entry.install_font_name.str());
+	std::cout << if_not_empty("  Strong assembly name", entry.strong_assembly_name.str());
 	
 	print(std::cout, entry, info.header);
 	
@@ -251,12 +251,12 @@ static void print_entry(const setup::info & info, size_t i,
 	
 	(void)i;
 	
-	std::cout << " - " << quoted(entry.name) << " -> " << quoted(entry.filename) << '\n';
-	std::cout << if_not_empty("  Parameters", entry.parameters);
-	std::cout << if_not_empty("  Working directory", entry.working_dir);
-	std::cout << if_not_empty("  Icon file", entry.icon_file);
-	std::cout << if_not_empty("  Comment", entry.comment);
-	std::cout << if_not_empty("  App user model id", entry.app_user_model_id);
+	std::cout << " - " << quoted(entry.name.str()) << " -> " << quoted(entry.filename.str()) << '\n';
+	std::cout << if_not_empty("  Parameters", entry.parameters.str());
+	std::cout << if_not_empty("  Working directory", entry.working_dir.str());
+	std::cout << if_not_empty("  Icon file", entry.icon_file.str());
+	std::cout << if_not_empty("  Comment", entry.comment.str());
+	std::cout << if_not_empty("  App user model id", entry.app_user_model_id.str());
 	
 	print(std::cout, entry, info.header);
 	
@@ -273,9 +273,9 @@ static void print_entry(const setup::info & info, size_t i,
 	
 	(void)i;
 	
-	std::cout << " - in " << quoted(entry.inifile);
-	std::cout << " set [" << quoted(entry.section) << "] ";
-	std::cout << quoted(entry.key) << " = " << quoted(entry.value) << '\n';
+	std::cout << " - in " << quoted(entry.inifile.str());
+	std::cout << " set [" << quoted(entry.section.str()) << "] ";
+	std::cout << quoted(entry.key.str()) << " = " << quoted(entry.value.str()) << '\n';
 	
 	print(std::cout, entry, info.header);
 	
@@ -299,7 +299,7 @@ static void print_entry(const setup::info & info, size_t i,
 		std::cout << quoted(entry.name);
 	}
 	if(!entry.value.empty()) {
-		std::cout << " = " << quoted(entry.value);
+		std::cout << " = " << quoted(entry.value.str());
 	}
 	if(entry.type != setup::registry_entry::None) {
 		std::cout << " (" << color::cyan << entry.type << color::reset << ')';
@@ -309,7 +309,7 @@ static void print_entry(const setup::info & info, size_t i,
 	print(std::cout, entry, info.header);
 	
 	if(!entry.permissions.empty()) {
-		std::cout << "  Permissions: " << entry.permissions.length() << " bytes";
+		std::cout << "  Permissions: " << entry.permissions.get().size() << " bytes";
 	}
 	std::cout << if_not_equal("  Permission entry", entry.permission, -1);
 	std::cout << if_not_zero("  Options", entry.options);
@@ -320,7 +320,7 @@ static void print_entry(const setup::info & info, size_t i,
 	
 	(void)i;
 	
-	std::cout << " - " << quoted(entry.name)
+	std::cout << " - " << quoted(entry.name.str())
 	     << " (" << color::cyan << entry.type << color::reset << ')' << '\n';
 	
 	print(std::cout, entry, info.header);
@@ -331,13 +331,13 @@ static void print_entry(const setup::info & info, size_t i,
 	
 	(void)i;
 	
-	std::cout << " - " << quoted(entry.name) << ':' << '\n';
-	std::cout << if_not_empty("  Parameters", entry.parameters);
-	std::cout << if_not_empty("  Working directory", entry.working_dir);
-	std::cout << if_not_empty("  Run once id", entry.run_once_id);
-	std::cout << if_not_empty("  Status message", entry.status_message);
-	std::cout << if_not_empty("  Verb", entry.verb);
-	std::cout << if_not_empty("  Description", entry.verb);
+	std::cout << " - " << quoted(entry.name.str()) << ':' << '\n';
+	std::cout << if_not_empty("  Parameters", entry.parameters.str());
+	std::cout << if_not_empty("  Working directory", entry.working_dir.str());
+	std::cout << if_not_empty("  Run once id", entry.run_once_id.str());
+	std::cout << if_not_empty("  Status message", entry.status_message.str());
+	std::cout << if_not_empty("  Verb", entry.verb.str());
+	std::cout << if_not_empty("  Description", entry.verb.str());
 	
 	print(std::cout, entry, info.header);
 	
@@ -23,7 +23,6 @@
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
-#include <map>
 #include <sstream>
 #include <vector>
 #include <cmath>
@@ -33,17 +32,20 @@
 #include <boost/unordered_map.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/filesystem/operations.hpp>
-#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <boost/range/size.hpp>
 #include <boost/lexical_cast.hpp>
 
 #include <boost/version.hpp>
-#if BOOST_VERSION >= 104800
-#include <boost/container/flat_map.hpp>
-#endif
 
+#include "cli/cache.hpp"
 #include "cli/debug.hpp"
 #include "cli/gog.hpp"
+#include "cli/journal.hpp"
+#include "cli/manifest.hpp"
+#include "cli/sink.hpp"
+
+#include "crypto/hasher.hpp"
 
 #include "loader/offsets.hpp"
 
@@ -115,23 +117,57 @@ static size_t probe_bin_files(const extract_options & o, const setup::info & inf
 	return count;
 }
 
-struct file_output {
+//! Get the timestamp to set for an extracted file.
+static util::time get_file_time(const extract_options & o, const setup::data_entry & data,
+                                util::local_time_converter & local_times) {
+	if(o.local_timestamps && !(data.options & data.TimeStampInUTC)) {
+		return local_times.convert(data.timestamp);
+	}
+	return data.timestamp;
+}
+
+/*!
+ * Check if a file extracted by a previous run still matches its data entry.
+ *
+ * Compares the size and (if file times are preserved) the modification time, as well as
+ * the contents for \ref UpdateByChecksum.
+ */
+static bool is_up_to_date(const extract_options & o, const fs::path & path,
+                          const setup::data_entry & data, util::time filetime) {
 	
-	fs::path name;
-	util::ofstream stream;
+	boost::system::error_code ec;
+	if(!fs::is_regular_file(path, ec) || fs::file_size(path, ec) != data.file.size || ec) {
+		return false;
+	}
 	
-	explicit file_output(const fs::path & file) : name(file) {
-		try {
-			stream.open(name, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
-			if(!stream.is_open()) {
-				throw 0;
+	if(o.preserve_file_times) {
+		std::time_t mtime = fs::last_write_time(path, ec);
+		if(ec || util::time(mtime) != filetime) {
+			return false;
+		}
+	}
+	
+	if(o.update == UpdateByChecksum) {
+		util::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+		if(!ifs.is_open()) {
+			return false;
+		}
+		crypto::hasher hasher(data.file.checksum.type);
+		while(!ifs.eof()) {
+			char buffer[8192 * 10];
+			std::streamsize n = ifs.read(buffer, std::streamsize(boost::size(buffer))).gcount();
+			if(ifs.bad()) {
+				return false;
 			}
-		} catch(...) {
-			throw std::runtime_error("Coul not open output file \"" + name.string() + '"');
+			hasher.update(buffer, size_t(n));
+		}
+		if(hasher.finalize() != data.file.checksum) {
+			return false;
 		}
 	}
 	
-};
+	return true;
+}
 
 template <typename Entry>
 class processed_item {
@@ -167,44 +203,171 @@ public:
 typedef processed_item<setup::file_entry> processed_file;
 typedef processed_item<setup::directory_entry> processed_directory;
 
+/*!
+ * Matches paths against the --include patterns in a single pass.
+ *
+ * Patterns starting with a path separator are anchored: they match if they are a prefix
+ * of path + sep when ignoring their leading separator. All other patterns match if
+ * sep + pattern + sep occurs anywhere in sep + path + sep.
+ * Anchored patterns are stored in a trie and the others in an Aho-Corasick automaton,
+ * both with dense transition tables over the bytes that occur in any pattern.
+ */
 class path_filter {
 	
-	typedef std::pair<bool, std::string> Filter;
-	std::vector<Filter> includes;
+	struct automaton {
+		std::vector<boost::uint32_t> next; //!< Transitions, indexed by node * classes + class.
+		std::vector<bool> accept;
+	};
 	
-public:
+	bool empty_;
 	
-	explicit path_filter(const extract_options & o) {
-		BOOST_FOREACH(const std::string & include, o.include) {
-			if(!include.empty() && include[0] == setup::path_sep) {
-				includes.push_back(Filter(true, boost::to_lower_copy(include) + setup::path_sep));
-			} else {
-				includes.push_back(Filter(false, setup::path_sep + boost::to_lower_copy(include)
-				                                 + setup::path_sep));
+	boost::uint16_t classes_[256]; //!< Byte class, 0 for bytes that do not occur in patterns.
+	size_t class_count_;
+	
+	automaton prefix_;    //!< Trie of anchored patterns.
+	automaton substring_; //!< Automaton of patterns that can match anywhere.
+	
+	boost::uint32_t transition(const automaton & a, boost::uint32_t node, char c) const {
+		return a.next[node * class_count_ + classes_[boost::uint8_t(c)]];
+	}
+	
+	void add_node(automaton & a) const {
+		a.next.resize(a.next.size() + class_count_, 0);
+		a.accept.push_back(false);
+	}
+	
+	void insert(automaton & a, const std::string & pattern) const {
+		if(a.accept.empty()) {
+			add_node(a);
+		}
+		boost::uint32_t node = 0;
+		BOOST_FOREACH(char c, pattern) {
+			size_t index = node * class_count_ + classes_[boost::uint8_t(c)];
+			if(!a.next[index]) {
+				// Edges never lead back to the root, so 0 means there is no edge yet
+				a.next[index] = boost::uint32_t(a.accept.size());
+				add_node(a);
 			}
+			node = a.next[index];
 		}
+		a.accept[node] = true;
 	}
 	
-	bool match(const std::string & path) const {
+	//! Add failure transitions to turn the trie into a complete Aho-Corasick automaton.
+	void link(automaton & a) const {
 		
-		if(includes.empty()) {
-			return true;
+		std::vector<boost::uint32_t> fail(a.accept.size(), 0);
+		std::vector<boost::uint32_t> queue;
+		queue.reserve(a.accept.size());
+		
+		for(size_t c = 0; c < class_count_; c++) {
+			if(a.next[c]) {
+				queue.push_back(a.next[c]);
+			}
 		}
 		
-		BOOST_FOREACH(const Filter & i, includes) {
-			if(i.first) {
-				if(!i.second.compare(1, i.second.size() - 1,
-				                     path + setup::path_sep, 0, i.second.size() - 1)) {
-					return true;
+		for(size_t i = 0; i < queue.size(); i++) {
+			boost::uint32_t node = queue[i];
+			for(size_t c = 0; c < class_count_; c++) {
+				boost::uint32_t & child = a.next[node * class_count_ + c];
+				boost::uint32_t fallback = a.next[fail[node] * class_count_ + c];
+				if(child) {
+					// Nodes are visited by depth, so the fallback is already complete
+					fail[child] = fallback;
+					if(a.accept[fallback]) {
+						a.accept[child] = true;
+					}
+					queue.push_back(child);
+				} else {
+					child = fallback;
 				}
+			}
+		}
+		
+	}
+	
+	bool match_prefix(const std::string & path) const {
+		
+		if(prefix_.accept.empty()) {
+			return false;
+		}
+		
+		boost::uint32_t node = 0;
+		BOOST_FOREACH(char c, path) {
+			node = transition(prefix_, node, c);
+			if(!node) {
+				return false;
+			} else if(prefix_.accept[node]) {
+				return true;
+			}
+		}
+		
+		node = transition(prefix_, node, setup::path_sep);
+		return node && prefix_.accept[node];
+	}
+	
+	bool match_substring(const std::string & path) const {
+		
+		if(substring_.accept.empty()) {
+			return false;
+		}
+		
+		boost::uint32_t node = transition(substring_, 0, setup::path_sep);
+		BOOST_FOREACH(char c, path) {
+			node = transition(substring_, node, c);
+			if(substring_.accept[node]) {
+				return true;
+			}
+		}
+		
+		node = transition(substring_, node, setup::path_sep);
+		return substring_.accept[node];
+	}
+	
+public:
+	
+	explicit path_filter(const extract_options & o)
+		: empty_(o.include.empty()), class_count_(1) {
+		
+		std::fill_n(classes_, size_t(boost::size(classes_)), boost::uint16_t(0));
+		
+		std::vector<std::string> prefixes, substrings;
+		BOOST_FOREACH(const std::string & include, o.include) {
+			if(!include.empty() && include[0] == setup::path_sep) {
+				prefixes.push_back(boost::to_lower_copy(include.substr(1)) + setup::path_sep);
 			} else {
-				if((setup::path_sep + path + setup::path_sep).find(i.second) != std::string::npos) {
-					return true;
+				substrings.push_back(setup::path_sep + boost::to_lower_copy(include)
+				                     + setup::path_sep);
+			}
+		}
+		
+		std::vector<std::string> * patterns[] = { &prefixes, &substrings };
+		BOOST_FOREACH(const std::vector<std::string> * list, patterns) {
+			BOOST_FOREACH(const std::string & pattern, *list) {
+				BOOST_FOREACH(char c, pattern) {
+					boost::uint16_t & byte_class = classes_[boost::uint8_t(c)];
+					if(!byte_class) {
+						byte_class = boost::uint16_t(class_count_++);
+					}
 				}
 			}
 		}
 		
-		return false;
+		BOOST_FOREACH(const std::string & pattern, prefixes) {
+			insert(prefix_, pattern);
+		}
+		
+		BOOST_FOREACH(const std::string & pattern, substrings) {
+			insert(substring_, pattern);
+		}
+		if(!substrings.empty()) {
+			link(substring_);
+		}
+		
+	}
+	
+	bool match(const std::string & path) const {
+		return empty_ || match_prefix(path) || match_substring(path);
 	}
 	
 };
@@ -326,73 +489,70 @@ static const char * handle_collision(const setup::file_entry & oldfile,
 }
 
 typedef boost::unordered_map<std::string, processed_file> FilesMap;
-#if BOOST_VERSION >= 104800
-typedef boost::container::flat_map<std::string, processed_directory> DirectoriesMap;
-#else
-typedef std::map<std::string, processed_directory> DirectoriesMap;
-#endif
+typedef boost::unordered_map<std::string, processed_directory> DirectoriesMap;
 typedef boost::unordered_map<std::string, std::vector<processed_file> > CollisionMap;
 
-static std::string parent_dir(const std::string & path) {
-	
-	size_t pos = path.find_last_of(setup::path_sep);
-	if(pos == std::string::npos) {
-		return std::string();
-	}
-	
-	return path.substr(0, pos);
-}
-
+/*!
+ * Add the parent directories of a path.
+ *
+ * Parents are visited from the innermost one outwards until one is found that has
+ * already been added. Parents of included paths are implied.
+ *
+ * \param internal_path Lowercase version of \c path, used as the key for directories.
+ * \param path          Path to add the parents for. If a parent was already added with
+ *                      different case, the start of the path is changed to match.
+ *
+ * \return \c true if the path was changed.
+ */
 static bool insert_dirs(DirectoriesMap & processed_directories, const path_filter & includes,
                         const std::string & internal_path, std::string & path, bool implied) {
 	
-	std::string dir = parent_dir(path);
-	std::string internal_dir = parent_dir(internal_path);
-	
-	if(internal_dir.empty()) {
-		return false;
-	}
-	
-	if(implied || includes.match(internal_dir)) {
+	// internal_path and path only differ in case, so parent directories have the same length
+	std::string internal_dir;
+	for(size_t end = internal_path.length(); end != 0;) {
 		
-		std::pair<DirectoriesMap::iterator, bool> existing = processed_directories.insert(
-			std::make_pair(internal_dir, processed_directory(dir))
-		);
+		end = internal_path.find_last_of(setup::path_sep, end - 1);
+		if(end == std::string::npos || end == 0) {
+			break;
+		}
+		internal_dir.assign(internal_path, 0, end);
 		
-		if(implied) {
-			existing.first->second.set_implied(true);
+		if(!implied && !includes.match(internal_dir)) {
+			continue;
 		}
 		
-		if(!existing.second) {
-			if(existing.first->second.path() != dir) {
-				// Existing dir case differs, fix path
-				if(existing.first->second.path().length() == dir.length()) {
-					path.replace(0, dir.length(), existing.first->second.path());
-				} else {
-					path = existing.first->second.path() + path.substr(dir.length());
-				}
-				return true;
-			} else {
-				return false;
-			}
+		DirectoriesMap::iterator existing = processed_directories.find(internal_dir);
+		if(existing == processed_directories.end()) {
+			processed_directory dir(path.substr(0, end), implied);
+			processed_directories.insert(std::make_pair(internal_dir, dir));
+			implied = true;
+			continue;
 		}
 		
-		implied = true;
-	}
-	
-	size_t oldlength = dir.length();
-	if(insert_dirs(processed_directories, includes, internal_dir, dir, implied)) {
-		if(dir.length() == oldlength) {
-			path.replace(0, dir.length(), dir);
-		} else {
-			path = dir + path.substr(oldlength);
+		if(implied) {
+			existing->second.set_implied(true);
 		}
-		return true;
+		
+		const std::string & dir = existing->second.path();
+		if(dir.length() != end || path.compare(0, end, dir) != 0) {
+			// Existing dir case differs, fix path
+			path.replace(0, end, dir);
+			return true;
+		}
+		
+		break;
 	}
 	
 	return false;
 }
 
+struct directory_order {
+	bool operator()(const DirectoriesMap::value_type * a,
+	                const DirectoriesMap::value_type * b) const {
+		return a->first < b->first;
+	}
+};
+
 static bool rename_collision(const extract_options & o, FilesMap & processed_files,
                              const std::string & path, const processed_file & other,
                              bool common_component, bool common_language, bool first) {
@@ -403,13 +563,13 @@ static bool rename_collision(const extract_options & o, FilesMap & processed_fil
 	std::ostringstream oss;
 	
 	if(!common_component && !file.components.empty()) {
-		if(setup::is_simple_expression(file.components)) {
+		if(setup::is_simple_expression(file.components.c_str())) {
 			require_number_suffix = false;
 			oss << '#' << file.components;
 		}
 	}
 	if(!common_language && !file.languages.empty()) {
-		if(setup::is_simple_expression(file.languages)) {
+		if(setup::is_simple_expression(file.languages.c_str())) {
 			require_number_suffix = false;
 			if(file.languages != o.default_language) {
 				oss << '@' << file.languages;
@@ -471,6 +631,72 @@ static void rename_collisions(const extract_options & o, FilesMap & processed_fi
 	}
 }
 
+/*!
+ * Output files for each data entry.
+ *
+ * The files for all data entries are stored in one array, grouped by data entry, with a
+ * second array holding the start of each group.
+ */
+class file_table {
+	
+	std::vector<const processed_file *> files_;
+	std::vector<size_t> starts_; //!< Start of the files for each location, followed by the end.
+	
+public:
+	
+	typedef boost::iterator_range<const processed_file * const *> range;
+	
+	/*!
+	 * \param files    Files to extract. Files for the same location keep their order.
+	 * \param locations Number of data entries.
+	 */
+	file_table(const std::vector<const processed_file *> & files, size_t locations)
+		: files_(files.size()), starts_(locations + 2) {
+		
+		// Count the files for each location, shifted by one so that the running total
+		// below ends up one location ahead of the start index
+		BOOST_FOREACH(const processed_file * file, files) {
+			starts_[file->entry().location + 2]++;
+		}
+		for(size_t i = 2; i < starts_.size(); i++) {
+			starts_[i] += starts_[i - 1];
+		}
+		
+		// Place each file at the next free index of its location
+		BOOST_FOREACH(const processed_file * file, files) {
+			files_[starts_[file->entry().location + 1]++] = file;
+		}
+		
+		starts_.pop_back();
+	}
+	
+	range operator[](size_t location) const {
+		const processed_file * const * base = files_.empty() ? NULL : &files_.front();
+		return range(base + starts_[location], base + starts_[location + 1]);
+	}
+	
+	bool empty(size_t location) const { return starts_[location] == starts_[location + 1]; }
+	
+};
+
+//! Orders data entries by chunk and by position within the chunk.
+struct location_order {
+	
+	const std::vector<setup::data_entry> & locations;
+	
+	explicit location_order(const std::vector<setup::data_entry> & l) : locations(l) { }
+	
+	bool operator()(size_t a, size_t b) const {
+		const setup::data_entry & first = locations[a];
+		const setup::data_entry & second = locations[b];
+		if(first.chunk == second.chunk) {
+			return first.file < second.file;
+		}
+		return first.chunk < second.chunk;
+	}
+	
+};
+
 } // anonymous namespace
 
 void process_file(const fs::path & file, const extract_options & o) {
@@ -527,7 +753,18 @@ void process_file(const fs::path & file, const extract_options & o) {
 	ifs.seekg(offsets.header_offset);
 	setup::info info;
 	try {
-		info.load(ifs, entries);
+		if(o.cache_dir.empty()) {
+			info.load(ifs, entries);
+		} else {
+			header_cache cache(o.cache_dir, file, offsets.header_offset);
+			if(!cache.load(ifs, info, entries)) {
+				ifs.clear();
+				ifs.seekg(offsets.header_offset);
+				std::string primary, secondary;
+				info.load(ifs, entries, primary, secondary);
+				cache.store(ifs, info, primary, secondary);
+			}
+		}
 	} catch(const std::ios_base::failure & e) {
 		std::ostringstream oss;
 		oss << "Stream error while parsing setup headers!\n";
@@ -621,7 +858,7 @@ void process_file(const fs::path & file, const extract_options & o) {
 	#endif
 	
 	DirectoriesMap processed_directories;
-	#if BOOST_VERSION >= 104800
+	#if BOOST_VERSION >= 105000
 	processed_directories.reserve(info.directories.size()
 	                              + size_t(std::log(double(info.files.size()))));
 	#endif
@@ -629,6 +866,8 @@ void process_file(const fs::path & file, const extract_options & o) {
 	CollisionMap collisions;
 	
 	path_filter includes(o);
+	setup::expression_matcher language_filter(o.language);
+	setup::expression_matcher default_language_filter(o.default_language);
 	
 	// Filter the directories to be created
 	BOOST_FOREACH(const setup::directory_entry & directory, info.directories) {
@@ -638,7 +877,7 @@ void process_file(const fs::path & file, const extract_options & o) {
 		}
 		
 		if(!directory.languages.empty()) {
-			if(!o.language.empty() && !setup::expression_match(o.language, directory.languages)) {
+			if(!o.language.empty() && !language_filter.match(directory.languages)) {
 				continue; // Ignore other languages
 			}
 		} else if(o.language_only) {
@@ -683,7 +922,7 @@ void process_file(const fs::path & file, const extract_options & o) {
 		}
 		
 		if(!file.languages.empty()) {
-			if(!o.language.empty() && !setup::expression_match(o.language, file.languages)) {
+			if(!o.language.empty() && !language_filter.match(file.languages)) {
 				continue; // Ignore other languages
 			}
 		} else if(o.language_only) {
@@ -723,8 +962,8 @@ void process_file(const fs::path & file, const extract_options & o) {
 				const char * skip = handle_collision(existing.entry(), olddata, file, newdata);
 				
 				if(!o.default_language.empty()) {
-					bool oldlang = setup::expression_match(o.default_language, file.languages);
-					bool newlang = setup::expression_match(o.default_language, existing.entry().languages);
+					bool oldlang = default_language_filter.match(file.languages);
+					bool newlang = default_language_filter.match(existing.entry().languages);
 					if(oldlang && !newlang) {
 						skip = NULL;
 					} else if(!oldlang && newlang) {
@@ -767,14 +1006,33 @@ void process_file(const fs::path & file, const extract_options & o) {
 	}
 	
 	
-	if(o.extract && !o.output_dir.empty()) {
-		fs::create_directories(o.output_dir);
+	// Files are written to the output directory unless a different sink was requested
+	boost::scoped_ptr<disk_sink> disk;
+	output_sink * sink = NULL;
+	if(o.extract) {
+		sink = o.sink;
+		if(!sink) {
+			disk.reset(new disk_sink(o));
+			sink = disk.get();
+		}
 	}
 	
+	// Inno Setup does not store directory timestamps
+	util::time now = util::time(std::time(NULL));
+	
 	if(o.list || o.extract) {
 		
+		// List and create directories sorted by path
+		std::vector<const DirectoriesMap::value_type *> directories;
+		directories.reserve(processed_directories.size());
 		BOOST_FOREACH(const DirectoriesMap::value_type & i, processed_directories) {
+			directories.push_back(&i);
+		}
+		std::sort(directories.begin(), directories.end(), directory_order());
+		
+		BOOST_FOREACH(const DirectoriesMap::value_type * directory, directories) {
 			
+			const DirectoriesMap::value_type & i = *directory;
 			const std::string & path = i.second.path();
 			
 			if(o.list && !i.second.implied()) {
@@ -794,47 +1052,90 @@ void process_file(const fs::path & file, const extract_options & o) {
 				
 			}
 			
-			if(o.extract) {
-				fs::path dir = o.output_dir / path;
-				try {
-					fs::create_directory(dir);
-				} catch(...) {
-					throw std::runtime_error("Could not create directory \"" + dir.string() + '"');
-				}
+			if(sink) {
+				sink->add_directory(path, now);
 			}
 			
 		}
 		
 	}
 	
-	std::vector< std::vector<const processed_file *> > files_for_location;
-	files_for_location.resize(info.data_entries.size());
+	util::local_time_converter local_times;
+	
+	// Only chunks that contain missing or outdated files need to be decompressed
+	bool update = (o.extract && !o.sink && o.update != ExtractAll);
+	size_t up_to_date = 0;
+	
+	boost::scoped_ptr<extract_journal> journal;
+	if(o.extract && !o.sink && o.resume) {
+		journal.reset(new extract_journal(o.output_dir, file));
+	}
+	
+	std::vector<const processed_file *> selected_files;
+	selected_files.reserve(processed_files.size());
 	BOOST_FOREACH(const FilesMap::value_type & i, processed_files) {
 		const processed_file & file = i.second;
-		files_for_location[file.entry().location].push_back(&file);
+		const setup::data_entry & data = info.data_entries[file.entry().location];
+		if(journal && journal->is_complete(file.path(), data.file.size, data.file.checksum)) {
+			continue;
+		}
+		if(update) {
+			util::time filetime = get_file_time(o, data, local_times);
+			if(is_up_to_date(o, o.output_dir / file.path(), data, filetime)) {
+				up_to_date++;
+				continue;
+			}
+		}
+		selected_files.push_back(&file);
 	}
+	file_table files_for_location(selected_files, info.data_entries.size());
 	
 	boost::uint64_t total_size = 0;
 	size_t max_slice = 0;
 	
-	typedef std::map<stream::file, size_t> Files;
-	typedef std::map<stream::chunk, Files> Chunks;
-	Chunks chunks;
+	util::time min_local_time = 0, max_local_time = -1;
+	
+	// Locations to process, sorted by chunk and position
+	std::vector<size_t> locations;
 	for(size_t i = 0; i < info.data_entries.size(); i++) {
 		setup::data_entry & location = info.data_entries[i];
 		if(!offsets.data_offset) {
 			max_slice = std::max(max_slice, location.chunk.first_slice);
 			max_slice = std::max(max_slice, location.chunk.last_slice);
 		}
-		if(files_for_location[i].empty()) {
+		if(files_for_location.empty(i)) {
 			continue;
 		}
 		if(location.chunk.compression == stream::UnknownCompression) {
 			location.chunk.compression = info.header.compression;
 		}
-		chunks[location.chunk][location.file] = i;
+		locations.push_back(i);
 		total_size += location.file.size;
+		if(!(location.options & location.TimeStampInUTC)) {
+			if(max_local_time < min_local_time) {
+				min_local_time = max_local_time = location.timestamp;
+			} else {
+				min_local_time = std::min(min_local_time, location.timestamp);
+				max_local_time = std::max(max_local_time, location.timestamp);
+			}
+		}
+	}
+	
+	if(o.extract && o.preserve_file_times && o.local_timestamps) {
+		local_times.prepare(min_local_time, max_local_time);
+	}
+	
+	location_order order(info.data_entries);
+	std::stable_sort(locations.begin(), locations.end(), order);
+	
+	// Locations that refer to the same data are only processed once, using the last one
+	size_t unique_locations = 0;
+	for(size_t i = 0; i < locations.size(); i++) {
+		if(i + 1 == locations.size() || order(locations[i], locations[i + 1])) {
+			locations[unique_locations++] = locations[i];
+		}
 	}
+	locations.resize(unique_locations);
 	
 	fs::path dir = file.parent_path();
 	std::string basename = util::as_string(file.stem());
@@ -851,25 +1152,34 @@ void process_file(const fs::path & file, const extract_options & o) {
 	progress extract_progress(total_size);
 	boost::uint64_t running_total = 0;
 
-	BOOST_FOREACH(const Chunks::value_type & chunk, chunks) {
+	for(size_t chunk_end = 0; chunk_end < locations.size();) {
 		
-		debug("[starting " << chunk.first.compression << " chunk @ slice " << chunk.first.first_slice
-		      << " + " << print_hex(offsets.data_offset) << " + " << print_hex(chunk.first.offset)
+		// Process all locations with the same chunk
+		size_t chunk_begin = chunk_end;
+		const stream::chunk & chunk = info.data_entries[locations[chunk_begin]].chunk;
+		while(chunk_end < locations.size()
+		      && info.data_entries[locations[chunk_end]].chunk == chunk) {
+			chunk_end++;
+		}
+		
+		debug("[starting " << chunk.compression << " chunk @ slice " << chunk.first_slice
+		      << " + " << print_hex(offsets.data_offset) << " + " << print_hex(chunk.offset)
 		      << ']');
 		
-		if(chunk.first.encrypted) {
+		if(chunk.encrypted) {
 			log_warning << "Skipping encrypted chunk (unsupported)";
 		}
 		
 		stream::chunk_reader::pointer chunk_source;
-		if((o.extract || o.test) && !chunk.first.encrypted) {
-			chunk_source = stream::chunk_reader::get(*slice_reader, chunk.first);
+		if((o.extract || o.test) && !chunk.encrypted) {
+			chunk_source = stream::chunk_reader::get(*slice_reader, chunk);
 		}
 		boost::uint64_t offset = 0;
 		
-		BOOST_FOREACH(const Files::value_type & location, chunk.second) {
-			const stream::file & file = location.first;
-			const std::vector<const processed_file *> & names = files_for_location[location.second];
+		for(size_t i = chunk_begin; i < chunk_end; i++) {
+			size_t location = locations[i];
+			const stream::file & file = info.data_entries[location].file;
+			file_table::range names = files_for_location[location];
 			
 			if(file.offset > offset) {
 				debug("discarding " << print_bytes(file.offset - offset)
@@ -892,7 +1202,7 @@ void process_file(const fs::path & file, const extract_options & o) {
 						if(named) {
 							std::cout << ", ";
 						}
-						if(chunk.first.encrypted) {
+						if(chunk.encrypted) {
 							std::cout << '"' << color::dim_yellow << name->path() << color::reset << '"';
 						} else {
 							std::cout << '"' << color::white << name->path() << color::reset << '"';
@@ -906,7 +1216,7 @@ void process_file(const fs::path & file, const extract_options & o) {
 					if(!o.quiet) {
 						print_size_info(file);
 					}
-					if(chunk.first.encrypted) {
+					if(chunk.encrypted) {
 						std::cout << " - encrypted";
 					}
 					std::cout << '\n';
@@ -943,55 +1253,57 @@ void process_file(const fs::path & file, const extract_options & o) {
 			stream::file_reader::pointer file_source;
 			file_source = stream::file_reader::get(*chunk_source, file, &checksum);
 			
+			const setup::data_entry & data = info.data_entries[location];
+			util::time filetime = o.preserve_file_times ? get_file_time(o, data, local_times) : now;
+			
 			// Open output files
-			boost::ptr_vector<file_output> output;
-			if(!o.test) {
-				output.reserve(names.size());
+			if(sink) {
+				std::vector<std::string> paths;
+				paths.reserve(names.size());
 				BOOST_FOREACH(const processed_file * name, names) {
-					try {
-						output.push_back(new file_output(o.output_dir / name->path()));
-					} catch(boost::bad_pointer &) {
-						// should never happen
-						std::terminate();
-					}
+					paths.push_back(name->path());
 				}
+				sink->begin_file(paths, data, filetime);
+			}
+			
+			if(o.manifest) {
+				o.manifest->begin_file();
 			}
 			
-			// Copy data
+			// Copy data, decoding it directly into the output if the sink provides a buffer
+			char * target = sink ? sink->file_buffer() : NULL;
+			boost::uint64_t position = 0;
 			while(!file_source->eof()) {
 				char buffer[8192 * 10];
-				std::streamsize buffer_size = std::streamsize(boost::size(buffer));
-				std::streamsize n = file_source->read(buffer, buffer_size).gcount();
+				char * block = buffer;
+				std::streamsize block_size = std::streamsize(boost::size(buffer));
+				if(target && position < file.size) {
+					// Once the output is full, keep reading into the buffer until the end of the
+					// input so that the checksum is finalized
+					boost::uint64_t remaining = file.size - position;
+					block = target + position;
+					block_size = std::streamsize(std::min(remaining, boost::uint64_t(1 << 20)));
+				}
+				std::streamsize n = file_source->read(block, block_size).gcount();
 				if(n > 0) {
-					BOOST_FOREACH(file_output & out, output) {
-						out.stream.write(buffer, n);
-						if(out.stream.fail()) {
-							throw std::runtime_error("Error writing file \""
-							                         + out.name.string() + '"');
-						}
+					if(sink) {
+						sink->write(block, size_t(n));
+					}
+					if(o.manifest) {
+						o.manifest->update(block, size_t(n));
 					}
 					extract_progress.update(boost::uint64_t(n));
 					running_total += n;
+					position += boost::uint64_t(n);
 				}
 			}
-
-			std::cout << "T$" << boost::lexical_cast<std::string>(running_total) << "$" << boost::lexical_cast<std::string>(total_size) << "$\n";
-
-			// Adjust file timestamps
-			if(o.preserve_file_times) {
-				const setup::data_entry & data = info.data_entries[location.second];
-				util::time filetime = data.timestamp;
-				if(o.local_timestamps && !(data.options & data.TimeStampInUTC)) {
-					filetime = util::to_local_time(filetime);
-				}
-				BOOST_FOREACH(file_output & out, output) {
-					out.stream.close();
-					if(!util::set_file_time(out.name, filetime, data.timestamp_nsec)) {
-						log_warning << "Error setting timestamp on file " << out.name;
-					}
-				}
+			
+			if(sink) {
+				sink->end_file();
 			}
 			
+			std::cout << "T$" << boost::lexical_cast<std::string>(running_total) << "$" << boost::lexical_cast<std::string>(total_size) << "$\n";
+			
 			// Verify checksums
 			if(checksum != file.checksum) {
 				log_warning << "Checksum mismatch:\n"
@@ -1000,19 +1312,47 @@ void process_file(const fs::path & file, const extract_options & o) {
 				if(o.test) {
 					throw std::runtime_error("Integrity test failed!");
 				}
+			} else if(journal) {
+				BOOST_FOREACH(const processed_file * name, names) {
+					journal->add(name->path(), file.size, file.checksum);
+				}
+			}
+			
+			if(o.manifest) {
+				o.manifest->end_file();
+				BOOST_FOREACH(const processed_file * name, names) {
+					o.manifest->add(name->path(), file.size, filetime, file.checksum);
+				}
 			}
 		}
 		
 		#ifdef DEBUG
-		if(offset < chunk.first.size) {
-			debug("discarding " << print_bytes(chunk.first.size - offset)
+		if(offset < chunk.size) {
+			debug("discarding " << print_bytes(chunk.size - offset)
 			      << " at end of chunk @ " << print_hex(offset));
 		}
 		#endif
+		
+		if(sink) {
+			sink->end_chunk();
+		}
 	}
 	
 	extract_progress.clear();
 	
+	if(sink) {
+		sink->finish();
+	}
+	
+	if(journal) {
+		journal->remove();
+	}
+	
+	if(up_to_date && !o.quiet) {
+		std::cout << "Skipped " << color::white << up_to_date << color::reset
+		          << (up_to_date == 1 ? " file that is" : " files that are") << " up to date\n";
+	}
+	
 	if(o.warn_unused || o.gog) {
 		size_t bin_count = 0;
 		bin_count += size_t(probe_bin_files(o, info, dir, basename + ".bin"));
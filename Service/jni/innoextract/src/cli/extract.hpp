@@ -30,10 +30,14 @@
 #include <string>
 #include <vector>
 
+#include <boost/cstdint.hpp>
 #include <boost/filesystem/path.hpp>
 
 #include "setup/filename.hpp"
 
+class manifest_writer;
+class output_sink;
+
 struct format_error : public std::runtime_error {
 	explicit format_error(const std::string & reason) : std::runtime_error(reason) { }
 };
@@ -45,6 +49,19 @@ enum CollisionAction {
 	ErrorOnCollisions
 };
 
+enum UpdateMode {
+	ExtractAll,
+	UpdateByTimestamp,
+	UpdateByChecksum
+};
+
+enum DurabilityMode {
+	SyncNone,
+	SyncAtEnd,
+	SyncEachChunk,
+	SyncEachFile
+};
+
 struct extract_options {
 	
 	bool quiet;
@@ -62,6 +79,12 @@ struct extract_options {
 	bool preserve_file_times; //!< Set timestamps of extracted files
 	bool local_timestamps; //!< Use local timezone for setting timestamps
 	
+	bool sparse; //!< Skip zero-filled blocks when writing files
+	boost::uint64_t direct_io_threshold; //!< Bypass the page cache for files this large
+	boost::uint64_t mmap_threshold; //!< Decode files this large into memory-mapped outputs
+	boost::uint64_t stage_threshold; //!< Write files smaller than this in batches
+	DurabilityMode durability; //!< When to make sure extracted data is on disk
+	
 	bool gog; //!< Try to extract additional archives used in GOG.com installers
 	
 	bool extract_temp; //!< Extract temporary files
@@ -71,9 +94,16 @@ struct extract_options {
 	
 	setup::filename_map filenames;
 	CollisionAction collisions;
+	UpdateMode update; //!< Only extract files that are missing or outdated
+	bool resume; //!< Keep a journal to skip completed files after an interruption
 	std::string default_language;
 	
 	boost::filesystem::path output_dir;
+	output_sink * sink; //!< Receives extracted files, or NULL to write them to output_dir
+	
+	manifest_writer * manifest; //!< Record digests of extracted files
+	
+	boost::filesystem::path cache_dir; //!< Cache decompressed setup headers, or empty
 	
 };
 
@@ -66,7 +66,7 @@ std::string get_game_id(const setup::info & info) {
 		}
 		
 		if(boost::iequals(entry.name, "gameID")) {
-			return entry.value;
+			return entry.value.str();
 		}
 		
 		if(id.empty()) {
@@ -415,6 +415,10 @@ void process_bin_files(const std::vector<fs::path> & files, const extract_option
 	if(!ifs.read(magic, std::streamsize(boost::size(magic))).fail()) {
 		
 		if(std::memcmp(magic, "Rar!", 4) == 0) {
+			if(o.extract && o.sink) {
+				throw std::runtime_error("Could not " + get_verb(o) + " \"" + files.front().string()
+				                         + "\": RAR archives can only be extracted to a directory");
+			}
 			ifs.close();
 			process_rar_files(files, o, info);
 			return;
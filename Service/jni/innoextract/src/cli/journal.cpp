@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "cli/journal.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "crypto/checksum.hpp"
+
+#include "util/log.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const char * const journal_name = ".innoextract-journal";
+
+const char * const journal_magic = "innoextract journal 1";
+
+std::string make_header(const fs::path & installer) {
+	std::ostringstream oss;
+	oss << journal_magic << '\t' << fs::file_size(installer)
+	    << '\t' << boost::int64_t(fs::last_write_time(installer));
+	return oss.str();
+}
+
+std::string make_record(boost::uint64_t size, const crypto::checksum & checksum) {
+	std::ostringstream oss;
+	oss << size << '\t' << checksum;
+	return oss.str();
+}
+
+} // anonymous namespace
+
+extract_journal::extract_journal(const fs::path & output_dir, const fs::path & installer)
+	: dir_(output_dir), path_(output_dir / journal_name) {
+	
+	std::string header = make_header(installer);
+	
+	// Load records from a previous run - lines are "<size>\t<checksum>\t<path>"
+	{
+		util::ifstream ifs(path_, std::ios_base::in | std::ios_base::binary);
+		std::string line;
+		if(ifs.is_open() && std::getline(ifs, line) && line == header) {
+			while(std::getline(ifs, line) && !ifs.eof()) {
+				size_t pos = line.rfind('\t');
+				if(pos != std::string::npos) {
+					records_[line.substr(pos + 1)] = line.substr(0, pos);
+				}
+			}
+		}
+	}
+	
+	if(!records_.empty()) {
+		log_info << "Resuming extraction, " << records_.size() << " files already done";
+	}
+	
+	/*
+	 * Rewrite the journal to drop records for other installers and lines that were only
+	 * partially written when the previous run was interrupted.
+	 */
+	ofs_.open(path_, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if(!ofs_.is_open()) {
+		throw std::runtime_error("Could not open journal file \"" + path_.string() + '"');
+	}
+	write(header);
+	for(record_map::const_iterator i = records_.begin(); i != records_.end(); ++i) {
+		ofs_ << i->second << '\t' << i->first << '\n';
+	}
+	ofs_.flush();
+	
+}
+
+void extract_journal::write(const std::string & line) {
+	ofs_ << line << '\n';
+	if(!ofs_.flush()) {
+		throw std::runtime_error("Could not write journal file \"" + path_.string() + '"');
+	}
+}
+
+bool extract_journal::is_complete(const std::string & path, boost::uint64_t size,
+                                  const crypto::checksum & checksum) const {
+	
+	record_map::const_iterator i = records_.find(path);
+	if(i == records_.end() || i->second != make_record(size, checksum)) {
+		return false;
+	}
+	
+	boost::system::error_code ec;
+	return fs::file_size(dir_ / path, ec) == size && !ec;
+}
+
+void extract_journal::add(const std::string & path, boost::uint64_t size,
+                          const crypto::checksum & checksum) {
+	write(make_record(size, checksum) + '\t' + path);
+}
+
+void extract_journal::remove() {
+	ofs_.close();
+	boost::system::error_code ec;
+	fs::remove(path_, ec);
+}
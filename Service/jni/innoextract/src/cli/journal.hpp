@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Journal of completed files used to resume interrupted extractions.
+ */
+#ifndef INNOEXTRACT_CLI_JOURNAL_HPP
+#define INNOEXTRACT_CLI_JOURNAL_HPP
+
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "util/fstream.hpp"
+
+namespace crypto { struct checksum; }
+
+/*!
+ * Append-only record of the files that have been completely extracted.
+ *
+ * The journal is stored in the output directory and tied to the size and modification
+ * time of the installer. Each record is flushed after the corresponding file has been
+ * written, so a killed process leaves a journal that only lists complete files.
+ * Records are only written for files whose checksum has been verified.
+ */
+class extract_journal : private boost::noncopyable {
+	
+	boost::filesystem::path dir_;
+	boost::filesystem::path path_;
+	util::ofstream ofs_;
+	
+	//! Completed files and their size and checksum.
+	typedef boost::unordered_map<std::string, std::string> record_map;
+	record_map records_;
+	
+	void write(const std::string & line);
+	
+public:
+	
+	/*!
+	 * Load the journal for an installer or start a new one.
+	 *
+	 * Records from an existing journal are only used if it was created for the same
+	 * installer file.
+	 *
+	 * \param output_dir The directory files are extracted to.
+	 * \param installer  The installer being extracted.
+	 */
+	extract_journal(const boost::filesystem::path & output_dir,
+	                const boost::filesystem::path & installer);
+	
+	/*!
+	 * Check if a file has been completely extracted by a previous run.
+	 *
+	 * \param path     Path of the file relative to the output directory.
+	 * \param size     Expected file size.
+	 * \param checksum Checksum of the file data.
+	 *
+	 * \return \c true if the journal has a matching record and the output file still
+	 *         has the recorded size.
+	 */
+	bool is_complete(const std::string & path, boost::uint64_t size,
+	                 const crypto::checksum & checksum) const;
+	
+	//! Record that a file has been completely extracted.
+	void add(const std::string & path, boost::uint64_t size, const crypto::checksum & checksum);
+	
+	//! Delete the journal after all files have been extracted.
+	void remove();
+	
+};
+
+#endif // INNOEXTRACT_CLI_JOURNAL_HPP
@@ -27,6 +27,7 @@
 
 #include <boost/foreach.hpp>
 #include <boost/program_options.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/operations.hpp>
@@ -34,14 +35,23 @@
 #include "release.hpp"
 
 #include "cli/extract.hpp"
+#include "cli/manifest.hpp"
+#include "cli/sink.hpp"
 
 #include "setup/version.hpp"
 
 #include "util/console.hpp"
+#include "util/file.hpp"
+#include "util/fstream.hpp"
 #include "util/log.hpp"
 #include "util/time.hpp"
 #include "util/windows.hpp"
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
 #include <android/log.h>
 
 #define LOGI(...) __android_log_write(2,"innoextract", __VA_ARGS__)
@@ -152,7 +162,26 @@ int main(int argc, char * argv[]) {
 		("lowercase,L", "Convert extracted filenames to lower-case")
 		("timestamps,T", po::value<std::string>(), "Timezone for file times or \"local\" or \"none\"")
 		("output-dir,d", po::value<std::string>(), "Extract files into the given directory")
+		("output-format", po::value<std::string>(),
+		 "Output format: \"directory\", \"tar\" or \"null\" to discard extracted data")
 		("gog,g", "Extract additional archives from GOG.com installers")
+		("sparse", "Create sparse files for zero-filled regions")
+		("direct-io", po::value<boost::uint64_t>()->implicit_value(64),
+		 "Bypass the page cache for files of at least this many MiB")
+		("mmap", po::value<boost::uint64_t>()->implicit_value(16),
+		 "Decode files of at least this many MiB directly into memory-mapped outputs")
+		("batch-small-files", po::value<boost::uint64_t>()->implicit_value(64),
+		 "Write files smaller than this many KiB in batches grouped by directory")
+		("durability", po::value<std::string>(),
+		 "When to sync extracted files to disk: \"none\", \"end\", \"per-chunk\" or \"per-file\"")
+		("update,u", po::value<std::string>()->implicit_value("timestamp"),
+		 "Only extract missing or changed files: \"timestamp\" or \"checksum\"")
+		("resume", "Keep a journal to resume interrupted extractions")
+		("cache-dir", po::value<std::string>(),
+		 "Cache decompressed setup headers in this directory")
+		("manifest", po::value<std::string>(), "Write digests of extracted files to this file")
+		("manifest-digests", po::value<std::string>(),
+		 "Digests to write to the manifest: \"sha256\", \"xxh64\" or both (default)")
 	;
 	
 	po::options_description filter("Filters");
@@ -269,6 +298,41 @@ int main(int argc, char * argv[]) {
 		o.list = true;
 	}
 	
+	// Output format
+	bool tar_output = false;
+	bool null_output = false;
+	std::string output_dir;
+	std::ostream archive_stdout(NULL);
+	{
+		po::variables_map::const_iterator i = options.find("output-format");
+		if(i != options.end()) {
+			std::string format = i->second.as<std::string>();
+			if(format == "tar") {
+				tar_output = true;
+			} else if(format == "null") {
+				null_output = true;
+			} else if(format != "directory") {
+				log_error << "Unsupported --output-format value: " << format;
+				return ExitUserError;
+			}
+		}
+		i = options.find("output-dir");
+		if(i != options.end()) {
+			output_dir = i->second.as<std::string>();
+		}
+		if(output_dir == "-") {
+			tar_output = true;
+			output_dir.clear();
+		}
+		if(o.extract && tar_output && output_dir.empty()) {
+			// Reserve standard output for the archive and print everything else to stderr
+			#ifdef _WIN32
+			_setmode(_fileno(stdout), _O_BINARY);
+			#endif
+			archive_stdout.rdbuf(std::cout.rdbuf(std::cerr.rdbuf()));
+		}
+	}
+	
 	// Additional actions.
 	o.filenames.set_expand(options.count("dump") == 0);
 	o.filenames.set_lowercase(options.count("lowercase") != 0);
@@ -290,6 +354,48 @@ int main(int argc, char * argv[]) {
 		}
 	}
 	
+	o.sparse = (options.count("sparse") != 0);
+	{
+		o.direct_io_threshold = boost::uint64_t(-1);
+		po::variables_map::const_iterator i = options.find("direct-io");
+		if(i != options.end()) {
+			o.direct_io_threshold = i->second.as<boost::uint64_t>() << 20;
+		}
+	}
+	{
+		o.mmap_threshold = boost::uint64_t(-1);
+		po::variables_map::const_iterator i = options.find("mmap");
+		if(i != options.end()) {
+			o.mmap_threshold = i->second.as<boost::uint64_t>() << 20;
+		}
+	}
+	{
+		o.stage_threshold = 0;
+		po::variables_map::const_iterator i = options.find("batch-small-files");
+		if(i != options.end()) {
+			o.stage_threshold = i->second.as<boost::uint64_t>() << 10;
+		}
+	}
+	{
+		o.durability = SyncNone;
+		po::variables_map::const_iterator i = options.find("durability");
+		if(i != options.end()) {
+			std::string durability = i->second.as<std::string>();
+			if(durability == "none") {
+				o.durability = SyncNone;
+			} else if(durability == "end") {
+				o.durability = SyncAtEnd;
+			} else if(durability == "per-chunk") {
+				o.durability = SyncEachChunk;
+			} else if(durability == "per-file") {
+				o.durability = SyncEachFile;
+			} else {
+				log_error << "Unsupported --durability value: " << durability;
+				return ExitUserError;
+			}
+		}
+	}
+	
 	// List version.
 	if(options.count("version") != 0) {
 		print_version(o);
@@ -317,6 +423,36 @@ int main(int argc, char * argv[]) {
 			}
 		}
 	}
+	{
+		o.update = ExtractAll;
+		po::variables_map::const_iterator i = options.find("update");
+		if(i != options.end()) {
+			std::string update = i->second.as<std::string>();
+			if(update == "timestamp") {
+				o.update = UpdateByTimestamp;
+			} else if(update == "checksum") {
+				o.update = UpdateByChecksum;
+			} else {
+				log_error << "Unsupported --update value: " << update;
+				return ExitUserError;
+			}
+			if(o.extract && (tar_output || null_output)) {
+				log_error << "--update can only be used when extracting to a directory!";
+				return ExitUserError;
+			}
+		}
+	}
+	o.resume = (options.count("resume") != 0);
+	if(o.resume && o.extract && (tar_output || null_output)) {
+		log_error << "--resume can only be used when extracting to a directory!";
+		return ExitUserError;
+	}
+	{
+		po::variables_map::const_iterator i = options.find("cache-dir");
+		if(i != options.end()) {
+			o.cache_dir = i->second.as<std::string>();
+		}
+	}
 	{
 		po::variables_map::const_iterator i = options.find("default-language");
 		if(i != options.end()) {
@@ -347,9 +483,12 @@ int main(int argc, char * argv[]) {
 		return ExitSuccess;
 	}
 	
+	util::ofstream archive_file;
+	boost::scoped_ptr<tar_sink> archive;
+	null_sink discard;
+	o.sink = NULL;
 	{
-		po::variables_map::const_iterator i = options.find("output-dir");
-		if(i != options.end()) {
+		if(!output_dir.empty()) {
 			/*
 			 * We can't use fs::path directly with boost::program_options as fs::path's
 			 * operator>> expects paths to be quoted if they contain spaces, breaking
@@ -357,7 +496,26 @@ int main(int argc, char * argv[]) {
 			 * Instead, do the conversion in the assignment operator.
 			 * See https://svn.boost.org/trac/boost/ticket/8535
 			 */
-			o.output_dir = i->second.as<std::string>();
+			o.output_dir = output_dir;
+		}
+		if(o.extract && tar_output) {
+			if(!o.output_dir.empty()) {
+				try {
+					archive_file.open(o.output_dir, std::ios_base::out | std::ios_base::binary
+					                                | std::ios_base::trunc);
+				} catch(...) { }
+				if(!archive_file.is_open()) {
+					log_error << "Could not open output archive " << o.output_dir;
+					return ExitDataError;
+				}
+				archive.reset(new tar_sink(archive_file));
+			} else {
+				archive.reset(new tar_sink(archive_stdout));
+			}
+			o.sink = archive.get();
+		} else if(o.extract && null_output) {
+			o.sink = &discard;
+		} else if(!output_dir.empty()) {
 			try {
 				if(!o.output_dir.empty() && !fs::exists(o.output_dir)) {
 					fs::create_directory(o.output_dir);
@@ -371,6 +529,31 @@ int main(int argc, char * argv[]) {
 	
 	o.gog = (options.count("gog") != 0);
 	
+	boost::scoped_ptr<manifest_writer> manifest;
+	o.manifest = NULL;
+	{
+		po::variables_map::const_iterator i = options.find("manifest");
+		if(i != options.end() && (o.extract || o.test)) {
+			if(o.extract && (o.update != ExtractAll || o.resume)) {
+				// Skipped files would be missing from the manifest
+				log_error << "--manifest cannot be combined with --update or --resume!";
+				return ExitUserError;
+			}
+			std::string digests = "sha256,xxh64";
+			po::variables_map::const_iterator j = options.find("manifest-digests");
+			if(j != options.end()) {
+				digests = j->second.as<std::string>();
+			}
+			try {
+				manifest.reset(new manifest_writer(i->second.as<std::string>(), digests));
+			} catch(const std::runtime_error & e) {
+				log_error << e.what();
+				return ExitUserError;
+			}
+			o.manifest = manifest.get();
+		}
+	}
+	
 	const std::vector<std::string> & files = options["setup-files"]
 	                                         .as< std::vector<std::string> >();
 	
@@ -379,6 +562,18 @@ int main(int argc, char * argv[]) {
 		BOOST_FOREACH(const std::string & file, files) {
 			process_file(file, o);
 		}
+		if(archive) {
+			archive->close();
+			archive_file.close();
+		}
+		// Archives are written as a single file so any durability mode syncs them at the end
+		bool sync_at_end = (o.durability == SyncAtEnd || (archive && o.durability != SyncNone));
+		if(o.extract && sync_at_end && !null_output && !(archive && o.output_dir.empty())) {
+			fs::path target = o.output_dir.empty() ? fs::path(".") : o.output_dir;
+			if(!util::sync_filesystem(target)) {
+				log_warning << "Could not make sure that extracted files were synced to disk";
+			}
+		}
 	} catch(const std::ios_base::failure & e) {
 		log_error << "Stream error while extracting files!\n"
 		          << " └─ error reason: " << e.what();
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "cli/manifest.hpp"
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/range/size.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include "crypto/checksum.hpp"
+
+namespace {
+
+void print_hex(std::ostream & os, const char * data, size_t size) {
+	for(size_t i = 0; i < size; i++) {
+		os << std::setfill('0') << std::hex << std::setw(2) << int(boost::uint8_t(data[i]));
+	}
+	os << std::dec;
+}
+
+//! Format an installer checksum as "<type>:<hex digest>".
+void print_checksum(std::ostream & os, const crypto::checksum & checksum) {
+	std::ios_base::fmtflags old_fmtflags = os.flags();
+	switch(checksum.type) {
+		case crypto::Adler32: {
+			os << "adler32:" << std::hex << std::setfill('0') << std::setw(8) << checksum.adler32;
+			break;
+		}
+		case crypto::CRC32: {
+			os << "crc32:" << std::hex << std::setfill('0') << std::setw(8) << checksum.crc32;
+			break;
+		}
+		case crypto::MD5: {
+			os << "md5:";
+			print_hex(os, checksum.md5, size_t(boost::size(checksum.md5)));
+			break;
+		}
+		case crypto::SHA1: {
+			os << "sha1:";
+			print_hex(os, checksum.sha1, size_t(boost::size(checksum.sha1)));
+			break;
+		}
+	}
+	os.flags(old_fmtflags);
+}
+
+} // anonymous namespace
+
+manifest_writer::manifest_writer(const boost::filesystem::path & path,
+                                 const std::string & digests)
+	: use_sha256_(false), use_xxh64_(false) {
+	
+	std::vector<std::string> names;
+	boost::split(names, digests, boost::is_any_of(","));
+	BOOST_FOREACH(const std::string & name, names) {
+		if(name == "sha256") {
+			use_sha256_ = true;
+		} else if(name == "xxh64") {
+			use_xxh64_ = true;
+		} else if(!name.empty()) {
+			throw std::runtime_error("Unsupported manifest digest: " + name);
+		}
+	}
+	
+	ofs_.open(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if(!ofs_.is_open()) {
+		throw std::runtime_error("Could not open manifest file \"" + path.string() + '"');
+	}
+	
+	ofs_ << "# path\tsize\tmtime\tchecksum";
+	if(use_sha256_) {
+		ofs_ << "\tsha256";
+	}
+	if(use_xxh64_) {
+		ofs_ << "\txxh64";
+	}
+	ofs_ << '\n';
+	
+}
+
+void manifest_writer::begin_file() {
+	if(use_sha256_) {
+		sha256_.init();
+	}
+	if(use_xxh64_) {
+		xxh64_.init();
+	}
+}
+
+void manifest_writer::end_file() {
+	
+	std::ostringstream oss;
+	
+	if(use_sha256_) {
+		char digest[crypto::sha256_transform::hash_size];
+		sha256_.finalize(digest);
+		oss << '\t';
+		print_hex(oss, digest, sizeof(digest));
+	}
+	
+	if(use_xxh64_) {
+		oss << '\t' << std::hex << std::setfill('0') << std::setw(16) << xxh64_.finalize();
+	}
+	
+	digests_ = oss.str();
+}
+
+void manifest_writer::add(const std::string & path, boost::uint64_t size, util::time mtime,
+                          const crypto::checksum & checksum) {
+	
+	ofs_ << path << '\t' << size << '\t' << mtime << '\t';
+	print_checksum(ofs_, checksum);
+	ofs_ << digests_ << '\n';
+	
+	if(ofs_.fail()) {
+		throw std::runtime_error("Could not write manifest file");
+	}
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Manifest of digests for extracted files.
+ */
+#ifndef INNOEXTRACT_CLI_MANIFEST_HPP
+#define INNOEXTRACT_CLI_MANIFEST_HPP
+
+#include <stddef.h>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "crypto/sha256.hpp"
+#include "crypto/xxhash.hpp"
+
+#include "util/fstream.hpp"
+#include "util/time.hpp"
+
+namespace crypto { struct checksum; }
+
+/*!
+ * Computes digests for file data as it is extracted and writes them to a manifest file.
+ *
+ * The manifest is a tab-separated text file with one line per file name:
+ * path, size, modification time, the checksum stored in the installer and the
+ * selected digests.
+ */
+class manifest_writer : private boost::noncopyable {
+	
+	util::ofstream ofs_;
+	
+	bool use_sha256_;
+	bool use_xxh64_;
+	
+	crypto::sha256 sha256_;
+	crypto::xxh64 xxh64_;
+	
+	std::string digests_; //!< Formatted digests of the last completed file.
+	
+public:
+	
+	/*!
+	 * Create a manifest file.
+	 *
+	 * \param path    The file to write the manifest to.
+	 * \param digests Comma-separated list of digests to compute: \c sha256 and \c xxh64.
+	 *
+	 * \throws std::runtime_error if the digest list is invalid or the file could not be
+	 *                            created.
+	 */
+	manifest_writer(const boost::filesystem::path & path, const std::string & digests);
+	
+	//! Start computing digests for a new file.
+	void begin_file();
+	
+	//! Add data for the current file.
+	void update(const char * data, size_t size) {
+		if(use_sha256_) {
+			sha256_.update(data, size);
+		}
+		if(use_xxh64_) {
+			xxh64_.update(data, size);
+		}
+	}
+	
+	//! Finish computing digests for the current file.
+	void end_file();
+	
+	/*!
+	 * Write a manifest record using the digests of the last completed file.
+	 *
+	 * \param path     Path of the extracted file.
+	 * \param size     Size of the file.
+	 * \param mtime    Modification time of the file.
+	 * \param checksum Checksum stored in the installer.
+	 */
+	void add(const std::string & path, boost::uint64_t size, util::time mtime,
+	         const crypto::checksum & checksum);
+	
+};
+
+#endif // INNOEXTRACT_CLI_MANIFEST_HPP
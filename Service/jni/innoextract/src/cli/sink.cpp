@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "cli/sink.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "configure.hpp"
+
+#if INNOEXTRACT_HAVE_STD_THREAD
+#include <functional>
+#include <mutex>
+#include <thread>
+#endif
+
+#include <boost/filesystem/operations.hpp>
+
+#include "setup/data.hpp"
+#include "setup/filename.hpp"
+
+#include "util/file.hpp"
+#include "util/log.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+//! Memory to use for staging small files before they are written.
+const size_t staging_budget = 16 * 1024 * 1024;
+
+//! Maximum number of threads to write staged files with.
+const size_t max_staging_threads = 4;
+
+} // anonymous namespace
+
+//! An open output file of a \ref disk_sink.
+struct disk_sink::output {
+	
+	fs::path name;
+	util::output_file file;
+	
+	output(const fs::path & path, bool sparse, bool direct) : name(path) {
+		if(!file.open(name)) {
+			throw std::runtime_error("Coul not open output file \"" + name.string() + '"');
+		}
+		if(sparse) {
+			file.set_sparse(true);
+		}
+		if(direct) {
+			file.enable_direct_io();
+		}
+	}
+	
+	void write(const char * data, size_t size) {
+		if(!file.write(data, size)) {
+			throw std::runtime_error("Error writing file \"" + name.string() + '"');
+		}
+	}
+	
+	//! Make sure the file has the correct size if it ends with a zero-filled region.
+	void flush() {
+		if(!file.flush()) {
+			throw std::runtime_error("Error writing file \"" + name.string() + '"');
+		}
+	}
+	
+	/*!
+	 * Set the file time using the open handle if possible so that the path does not need
+	 * to be resolved again. Closes the file if the handle cannot be used.
+	 */
+	void set_time(util::time t, boost::uint32_t nsec) {
+		if(util::set_file_time(file.handle(), t, nsec)) {
+			return;
+		}
+		file.close();
+		if(!util::set_file_time(name, t, nsec)) {
+			log_warning << "Error setting timestamp on file " << name;
+		}
+	}
+	
+	//! Write the file data to disk before returning.
+	void sync() {
+		if(file.is_open() && !file.sync()) {
+			throw std::runtime_error("Error syncing file \"" + name.string() + '"');
+		}
+	}
+	
+	//! Hand the file to a background thread that writes it to disk and closes it.
+	void sync(util::background_syncer & syncer) {
+		if(file.is_open()) {
+			syncer.add(file.release());
+		}
+	}
+	
+};
+
+//! Data and metadata for a file that has not been written yet.
+struct disk_sink::staged_file {
+	
+	std::vector<fs::path> paths;
+	std::string data;
+	util::time mtime;
+	boost::uint32_t nsec;
+	
+	//! Get the directory to group the file by.
+	fs::path directory() const { return paths.front().parent_path(); }
+	
+	static bool by_directory(const staged_file * a, const staged_file * b) {
+		return a->directory() < b->directory();
+	}
+	
+};
+
+disk_sink::disk_sink(const extract_options & o)
+	: dir_(o.output_dir), sparse_(o.sparse), direct_io_threshold_(o.direct_io_threshold)
+	, mmap_threshold_(o.mmap_threshold), stage_threshold_(o.stage_threshold)
+	, preserve_file_times_(o.preserve_file_times), durability_(o.durability)
+	, mapped_(NULL), mtime_(0), nsec_(0), staging_(NULL), staged_size_(0) {
+	
+	if(!dir_.empty()) {
+		fs::create_directories(dir_);
+	}
+	
+	// Files in the journal must already be on disk
+	if(o.resume) {
+		stage_threshold_ = 0;
+	}
+	
+	if(durability_ == SyncEachChunk) {
+		syncer_.reset(new util::background_syncer);
+	}
+}
+
+disk_sink::~disk_sink() { }
+
+void disk_sink::add_directory(const std::string & path, util::time mtime) {
+	(void)mtime; // Not set as adding files would change it again
+	fs::path dir = dir_ / path;
+	try {
+		fs::create_directory(dir);
+	} catch(...) {
+		throw std::runtime_error("Could not create directory \"" + dir.string() + '"');
+	}
+}
+
+void disk_sink::begin_file(const std::vector<std::string> & paths,
+                           const setup::data_entry & data, util::time mtime) {
+	
+	outputs_.clear();
+	mapped_ = NULL;
+	mtime_ = mtime;
+	nsec_ = data.timestamp_nsec;
+	
+	if(data.file.size < stage_threshold_) {
+		staging_ = new staged_file;
+		staged_.push_back(staging_);
+		staging_->paths.reserve(paths.size());
+		for(size_t i = 0; i < paths.size(); i++) {
+			staging_->paths.push_back(dir_ / paths[i]);
+		}
+		staging_->data.reserve(size_t(data.file.size));
+		staging_->mtime = mtime;
+		staging_->nsec = data.timestamp_nsec;
+		return;
+	}
+	
+	bool direct = (data.file.size >= direct_io_threshold_);
+	outputs_.reserve(paths.size());
+	for(size_t i = 0; i < paths.size(); i++) {
+		try {
+			outputs_.push_back(new output(dir_ / paths[i], sparse_, direct));
+		} catch(boost::bad_pointer &) {
+			// should never happen
+			std::terminate();
+		}
+	}
+	
+	/*
+	 * Large files are decoded directly into the page cache instead of being copied there.
+	 * Mapped pages are always written in full, so this is not used for sparse files.
+	 */
+	bool map = (data.file.size >= mmap_threshold_ && !direct && !sparse_);
+	if(map && outputs_.size() == 1) {
+		mapped_ = outputs_[0].file.map(data.file.size);
+	}
+}
+
+void disk_sink::write(const char * data, size_t size) {
+	if(staging_) {
+		staging_->data.append(data, size);
+		return;
+	}
+	for(size_t i = 0; i < outputs_.size(); i++) {
+		outputs_[i].write(data, size);
+	}
+}
+
+void disk_sink::finish_output(output & out, util::time mtime, boost::uint32_t nsec) {
+	
+	out.flush();
+	
+	// Adjust file timestamps
+	if(preserve_file_times_) {
+		out.set_time(mtime, nsec);
+	}
+	
+	// Make sure the data reaches the disk
+	if(durability_ == SyncEachFile) {
+		out.sync();
+	} else if(syncer_) {
+		out.sync(*syncer_);
+	}
+	
+	out.file.close();
+}
+
+void disk_sink::end_file() {
+	
+	if(staging_) {
+		staged_size_ += staging_->data.size();
+		staging_ = NULL;
+		if(staged_size_ >= staging_budget) {
+			flush_staged();
+		}
+		return;
+	}
+	
+	mapped_ = NULL;
+	
+	for(size_t i = 0; i < outputs_.size(); i++) {
+		finish_output(outputs_[i], mtime_, nsec_);
+	}
+	
+	outputs_.clear();
+}
+
+void disk_sink::write_staged(const staged_file & file) {
+	for(size_t i = 0; i < file.paths.size(); i++) {
+		output out(file.paths[i], sparse_, false);
+		out.write(file.data.data(), file.data.size());
+		finish_output(out, file.mtime, file.nsec);
+	}
+}
+
+//! Writes groups of staged files, taking the next group from a shared list.
+struct disk_sink::staged_writer {
+	
+	disk_sink & sink;
+	const std::vector<const staged_file *> & files;
+	const std::vector<size_t> & groups; //!< Start index of each group, followed by the end.
+	
+	size_t next;
+	std::string error;
+	
+	#if INNOEXTRACT_HAVE_STD_THREAD
+	std::mutex mutex;
+	#endif
+	
+	staged_writer(disk_sink & s, const std::vector<const staged_file *> & f,
+	              const std::vector<size_t> & g)
+		: sink(s), files(f), groups(g), next(0) { }
+	
+	bool take(size_t & group) {
+		#if INNOEXTRACT_HAVE_STD_THREAD
+		std::lock_guard<std::mutex> lock(mutex);
+		#endif
+		if(next + 1 >= groups.size() || !error.empty()) {
+			return false;
+		}
+		group = next++;
+		return true;
+	}
+	
+	void fail(const std::string & message) {
+		#if INNOEXTRACT_HAVE_STD_THREAD
+		std::lock_guard<std::mutex> lock(mutex);
+		#endif
+		if(error.empty()) {
+			error = message;
+		}
+	}
+	
+	void operator()() {
+		size_t group;
+		while(take(group)) {
+			try {
+				for(size_t i = groups[group]; i < groups[group + 1]; i++) {
+					sink.write_staged(*files[i]);
+				}
+			} catch(const std::exception & e) {
+				fail(e.what());
+			}
+		}
+	}
+	
+};
+
+void disk_sink::flush_staged() {
+	
+	if(staged_.empty()) {
+		return;
+	}
+	
+	// Group files by directory so that each directory is only modified by one thread
+	std::vector<const staged_file *> files;
+	files.reserve(staged_.size());
+	for(size_t i = 0; i < staged_.size(); i++) {
+		files.push_back(&staged_[i]);
+	}
+	std::stable_sort(files.begin(), files.end(), staged_file::by_directory);
+	std::vector<size_t> groups;
+	for(size_t i = 0; i < files.size(); i++) {
+		if(i == 0 || files[i]->directory() != files[i - 1]->directory()) {
+			groups.push_back(i);
+		}
+	}
+	groups.push_back(files.size());
+	
+	staged_writer writer(*this, files, groups);
+	
+	#if INNOEXTRACT_HAVE_STD_THREAD
+	size_t thread_count = std::min(size_t(std::thread::hardware_concurrency()), max_staging_threads);
+	thread_count = std::min(thread_count, groups.size() - 1);
+	std::vector<std::thread> threads;
+	for(size_t i = 1; i < thread_count; i++) {
+		threads.push_back(std::thread(std::ref(writer)));
+	}
+	writer();
+	for(size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+	#else
+	writer();
+	#endif
+	
+	staged_.clear();
+	staged_size_ = 0;
+	
+	if(!writer.error.empty()) {
+		throw std::runtime_error(writer.error);
+	}
+}
+
+void disk_sink::end_chunk() {
+	
+	flush_staged();
+	
+	// Sync files from this chunk while the next chunk is decompressed
+	if(syncer_) {
+		syncer_->commit();
+	}
+}
+
+void disk_sink::finish() {
+	flush_staged();
+	if(syncer_ && !syncer_->finish()) {
+		throw std::runtime_error("Error syncing extracted files");
+	}
+}
+
+namespace {
+
+//! Convert a path to the format used in tar archives.
+std::string archive_path(const std::string & path) {
+	std::string result = path;
+	std::replace(result.begin(), result.end(), setup::path_sep, '/');
+	return result;
+}
+
+} // anonymous namespace
+
+void tar_sink::add_directory(const std::string & path, util::time mtime) {
+	archive_.add_directory(archive_path(path), mtime);
+}
+
+void tar_sink::begin_file(const std::vector<std::string> & paths,
+                          const setup::data_entry & data, util::time mtime) {
+	paths_ = paths;
+	mtime_ = mtime;
+	archive_.begin_file(archive_path(paths_.front()), data.file.size, mtime);
+}
+
+void tar_sink::write(const char * data, size_t size) {
+	archive_.write(data, size);
+}
+
+void tar_sink::end_file() {
+	
+	if(!archive_.end_file()) {
+		log_warning << "Unexpected end of data for " << paths_.front();
+	}
+	
+	// Store additional names for the same data as hard links
+	std::string target = archive_path(paths_.front());
+	for(size_t i = 1; i < paths_.size(); i++) {
+		archive_.add_link(archive_path(paths_[i]), target, mtime_);
+	}
+}
+
+void tar_sink::close() {
+	archive_.close();
+}
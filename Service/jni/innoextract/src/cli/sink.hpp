@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Destinations for extracted file data.
+ */
+#ifndef INNOEXTRACT_CLI_SINK_HPP
+#define INNOEXTRACT_CLI_SINK_HPP
+
+#include <stddef.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include "cli/extract.hpp"
+
+#include "util/tar.hpp"
+#include "util/time.hpp"
+
+namespace setup { struct data_entry; }
+namespace util { class background_syncer; }
+
+/*!
+ * Receives the files extracted by \ref process_file.
+ *
+ * For each file, \ref begin_file is called once, followed by any number of calls to
+ * \ref write with consecutive blocks of the file data and finally \ref end_file.
+ * Paths use \ref setup::path_sep as the directory separator and are relative to the
+ * output root.
+ */
+class output_sink : private boost::noncopyable {
+	
+public:
+	
+	virtual ~output_sink() { }
+	
+	/*!
+	 * Create a directory.
+	 *
+	 * Parent directories are always created before their children.
+	 */
+	virtual void add_directory(const std::string & path, util::time mtime) {
+		(void)path, (void)mtime;
+	}
+	
+	/*!
+	 * Start a new file.
+	 *
+	 * \param paths All names for the file data. There is at least one name.
+	 * \param data  Metadata for the file.
+	 * \param mtime Modification time to use for the file.
+	 */
+	virtual void begin_file(const std::vector<std::string> & paths,
+	                        const setup::data_entry & data, util::time mtime) = 0;
+	
+	/*!
+	 * Add data to the current file.
+	 *
+	 * The data is only valid for the duration of the call.
+	 */
+	virtual void write(const char * data, size_t size) = 0;
+	
+	/*!
+	 * Get memory to decode the data of the current file into.
+	 *
+	 * If this returns a buffer, each block of file data is stored at its position in the
+	 * buffer before being passed to \ref write, which then does not need to copy it.
+	 *
+	 * \return a buffer for the complete file data or \c NULL.
+	 */
+	virtual char * file_buffer() { return NULL; }
+	
+	//! Finish the current file.
+	virtual void end_file() = 0;
+	
+	//! Called after all files stored in the same compressed chunk have been written.
+	virtual void end_chunk() { }
+	
+	//! Called after all files from an installer have been written.
+	virtual void finish() { }
+	
+};
+
+/*!
+ * Writes extracted files to an output directory.
+ *
+ * Small files can be staged in memory and written in batches, grouped by directory,
+ * from several threads at the end of each chunk or when the staging area is full.
+ */
+class disk_sink : public output_sink {
+	
+	struct output;
+	struct staged_file;
+	struct staged_writer;
+	
+	boost::filesystem::path dir_;
+	bool sparse_;
+	boost::uint64_t direct_io_threshold_;
+	boost::uint64_t mmap_threshold_;
+	boost::uint64_t stage_threshold_;
+	bool preserve_file_times_;
+	DurabilityMode durability_;
+	
+	boost::ptr_vector<output> outputs_;
+	char * mapped_; //!< Mapped contents of the only output file.
+	util::time mtime_;
+	boost::uint32_t nsec_;
+	
+	boost::ptr_vector<staged_file> staged_;
+	staged_file * staging_; //!< The current file if it is being staged.
+	size_t staged_size_;
+	
+	boost::scoped_ptr<util::background_syncer> syncer_;
+	
+	//! Flush and close an output file, setting its time and syncing it as requested.
+	void finish_output(output & out, util::time mtime, boost::uint32_t nsec);
+	
+	void write_staged(const staged_file & file);
+	void flush_staged();
+	
+public:
+	
+	//! Create a sink using the output directory and file settings from \c o.
+	explicit disk_sink(const extract_options & o);
+	
+	~disk_sink();
+	
+	void add_directory(const std::string & path, util::time mtime);
+	void begin_file(const std::vector<std::string> & paths,
+	                const setup::data_entry & data, util::time mtime);
+	void write(const char * data, size_t size);
+	char * file_buffer() { return mapped_; }
+	void end_file();
+	void end_chunk();
+	void finish();
+	
+};
+
+/*!
+ * Writes extracted files to a tar archive.
+ *
+ * Additional names for the same file data are stored as hard links.
+ */
+class tar_sink : public output_sink {
+	
+	util::tar_writer archive_;
+	std::vector<std::string> paths_;
+	util::time mtime_;
+	
+public:
+	
+	explicit tar_sink(std::ostream & os) : archive_(os) { }
+	
+	void add_directory(const std::string & path, util::time mtime);
+	void begin_file(const std::vector<std::string> & paths,
+	                const setup::data_entry & data, util::time mtime);
+	void write(const char * data, size_t size);
+	void end_file();
+	
+	//! Write the end of archive marker.
+	void close();
+	
+};
+
+//! Discards all extracted data.
+class null_sink : public output_sink {
+	
+public:
+	
+	void begin_file(const std::vector<std::string> & paths,
+	                const setup::data_entry & data, util::time mtime) {
+		(void)paths, (void)data, (void)mtime;
+	}
+	void write(const char * data, size_t size) { (void)data, (void)size; }
+	void end_file() { }
+	
+};
+
+//! Passes extracted files to user-provided functions.
+class callback_sink : public output_sink {
+	
+public:
+	
+	typedef boost::function<void (const std::vector<std::string> & paths,
+	                              const setup::data_entry & data, util::time mtime)> begin_function;
+	typedef boost::function<void (const char * data, size_t size)> write_function;
+	typedef boost::function<void ()> end_function;
+	
+	/*!
+	 * \param begin Called by \ref begin_file.
+	 * \param write Called by \ref write.
+	 * \param end   Called by \ref end_file.
+	 */
+	callback_sink(const begin_function & begin, const write_function & write,
+	              const end_function & end)
+		: begin_(begin), write_(write), end_(end) { }
+	
+	void begin_file(const std::vector<std::string> & paths,
+	                const setup::data_entry & data, util::time mtime) {
+		begin_(paths, data, mtime);
+	}
+	void write(const char * data, size_t size) { write_(data, size); }
+	void end_file() { end_(); }
+	
+private:
+	
+	begin_function begin_;
+	write_function write_;
+	end_function end_;
+	
+};
+
+#endif // INNOEXTRACT_CLI_SINK_HPP
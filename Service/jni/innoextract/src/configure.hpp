@@ -14,6 +14,14 @@
 #undef INNOEXTRACT_HAVE_DYNAMIC_UTIMENSAT
 #define INNOEXTRACT_HAVE_AT_FDCWD true
 #define INNOEXTRACT_HAVE_UTIMES true
+#define INNOEXTRACT_HAVE_FUTIMENS true
+#undef INNOEXTRACT_HAVE_FUTIMES
+#define INNOEXTRACT_HAVE_O_DIRECT true
+#define INNOEXTRACT_HAVE_POSIX_MEMALIGN true
+#define INNOEXTRACT_HAVE_MMAP true
+#define INNOEXTRACT_HAVE_POSIX_FALLOCATE true
+#define INNOEXTRACT_HAVE_FDATASYNC true
+#undef INNOEXTRACT_HAVE_SYNCFS
 
 // Endianness
 #undef INNOEXTRACT_HAVE_BUILTIN_BSWAP16
@@ -27,6 +35,7 @@
 #undef INNOEXTRACT_HAVE_ALIGNOF
 #define INNOEXTRACT_HAVE_STD_CODECVT_UTF8_UTF16 true
 #define INNOEXTRACT_HAVE_STD_UNIQUE_PTR true
+#define INNOEXTRACT_HAVE_STD_THREAD true
 
 // Optional dependencies
 #define INNOEXTRACT_HAVE_LZMA 1
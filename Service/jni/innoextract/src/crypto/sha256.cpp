@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "crypto/sha256.hpp"
+
+#include "util/math.hpp"
+
+namespace crypto {
+
+namespace {
+
+const boost::uint32_t round_constants[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline boost::uint32_t rotr(boost::uint32_t x, unsigned int y) {
+	return util::rotl_fixed(x, 32 - y);
+}
+
+} // anonymous namespace
+
+void sha256_transform::init(hash_word * state) {
+	state[0] = 0x6a09e667;
+	state[1] = 0xbb67ae85;
+	state[2] = 0x3c6ef372;
+	state[3] = 0xa54ff53a;
+	state[4] = 0x510e527f;
+	state[5] = 0x9b05688c;
+	state[6] = 0x1f83d9ab;
+	state[7] = 0x5be0cd19;
+}
+
+void sha256_transform::transform(hash_word * state, const hash_word * data) {
+	
+	hash_word W[64];
+	
+	for(size_t i = 0; i < 16; i++) {
+		W[i] = data[i];
+	}
+	for(size_t i = 16; i < 64; i++) {
+		hash_word s0 = rotr(W[i - 15], 7) ^ rotr(W[i - 15], 18) ^ (W[i - 15] >> 3);
+		hash_word s1 = rotr(W[i - 2], 17) ^ rotr(W[i - 2], 19) ^ (W[i - 2] >> 10);
+		W[i] = W[i - 16] + s0 + W[i - 7] + s1;
+	}
+	
+	hash_word a = state[0];
+	hash_word b = state[1];
+	hash_word c = state[2];
+	hash_word d = state[3];
+	hash_word e = state[4];
+	hash_word f = state[5];
+	hash_word g = state[6];
+	hash_word h = state[7];
+	
+	for(size_t i = 0; i < 64; i++) {
+		hash_word S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+		hash_word ch = g ^ (e & (f ^ g));
+		hash_word t1 = h + S1 + ch + round_constants[i] + W[i];
+		hash_word S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+		hash_word maj = (a & b) | (c & (a | b));
+		hash_word t2 = S0 + maj;
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+	
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+	
+}
+
+} // namespace crypto
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+// Implementation of the XXH64 algorithm by Yann Collet.
+
+#include "crypto/xxhash.hpp"
+
+#include <cstring>
+
+#include "util/endian.hpp"
+#include "util/math.hpp"
+
+namespace crypto {
+
+namespace {
+
+const boost::uint64_t prime1 = (boost::uint64_t(0x9e3779b1) << 32) | 0x85ebca87;
+const boost::uint64_t prime2 = (boost::uint64_t(0xc2b2ae3d) << 32) | 0x27d4eb4f;
+const boost::uint64_t prime3 = (boost::uint64_t(0x165667b1) << 32) | 0x9e3779f9;
+const boost::uint64_t prime4 = (boost::uint64_t(0x85ebca77) << 32) | 0xc2b2ae63;
+const boost::uint64_t prime5 = (boost::uint64_t(0x27d4eb2f) << 32) | 0x165667c5;
+
+inline boost::uint64_t round(boost::uint64_t acc, boost::uint64_t input) {
+	acc += input * prime2;
+	acc = util::rotl_fixed(acc, 31);
+	return acc * prime1;
+}
+
+inline boost::uint64_t merge_round(boost::uint64_t acc, boost::uint64_t value) {
+	acc ^= round(0, value);
+	return acc * prime1 + prime4;
+}
+
+inline const char * process(boost::uint64_t * state, const char * data, const char * end) {
+	boost::uint64_t v0 = state[0], v1 = state[1], v2 = state[2], v3 = state[3];
+	for(; end - data >= 32; data += 32) {
+		v0 = round(v0, util::little_endian::load<boost::uint64_t>(data));
+		v1 = round(v1, util::little_endian::load<boost::uint64_t>(data + 8));
+		v2 = round(v2, util::little_endian::load<boost::uint64_t>(data + 16));
+		v3 = round(v3, util::little_endian::load<boost::uint64_t>(data + 24));
+	}
+	state[0] = v0, state[1] = v1, state[2] = v2, state[3] = v3;
+	return data;
+}
+
+} // anonymous namespace
+
+void xxh64::init(boost::uint64_t initial_seed) {
+	seed = initial_seed;
+	state[0] = seed + prime1 + prime2;
+	state[1] = seed + prime2;
+	state[2] = seed;
+	state[3] = seed - prime1;
+	total = 0;
+	buffered = 0;
+}
+
+void xxh64::update(const char * data, size_t length) {
+	
+	const char * end = data + length;
+	total += length;
+	
+	if(buffered + length < block_size) {
+		std::memcpy(buffer + buffered, data, length);
+		buffered += length;
+		return;
+	}
+	
+	if(buffered) {
+		size_t n = block_size - buffered;
+		std::memcpy(buffer + buffered, data, n);
+		process(state, buffer, buffer + block_size);
+		data += n;
+		buffered = 0;
+	}
+	
+	data = process(state, data, end);
+	
+	buffered = size_t(end - data);
+	std::memcpy(buffer, data, buffered);
+}
+
+boost::uint64_t xxh64::finalize() const {
+	
+	boost::uint64_t hash;
+	if(total >= block_size) {
+		hash = util::rotl_fixed(state[0], 1) + util::rotl_fixed(state[1], 7)
+		     + util::rotl_fixed(state[2], 12) + util::rotl_fixed(state[3], 18);
+		for(size_t i = 0; i < 4; i++) {
+			hash = merge_round(hash, state[i]);
+		}
+	} else {
+		hash = seed + prime5;
+	}
+	
+	hash += total;
+	
+	const char * data = buffer;
+	const char * end = buffer + buffered;
+	
+	for(; end - data >= 8; data += 8) {
+		hash ^= round(0, util::little_endian::load<boost::uint64_t>(data));
+		hash = util::rotl_fixed(hash, 27) * prime1 + prime4;
+	}
+	
+	if(end - data >= 4) {
+		hash ^= boost::uint64_t(util::little_endian::load<boost::uint32_t>(data)) * prime1;
+		hash = util::rotl_fixed(hash, 23) * prime2 + prime3;
+		data += 4;
+	}
+	
+	for(; data != end; data++) {
+		hash ^= boost::uint64_t(boost::uint8_t(*data)) * prime5;
+		hash = util::rotl_fixed(hash, 11) * prime1;
+	}
+	
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+	
+	return hash;
+}
+
+} // namespace crypto
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * XXH64 non-cryptographic hash function.
+ */
+#ifndef INNOEXTRACT_CRYPTO_XXHASH_HPP
+#define INNOEXTRACT_CRYPTO_XXHASH_HPP
+
+#include <stddef.h>
+
+#include <boost/cstdint.hpp>
+
+#include "crypto/checksum.hpp"
+
+namespace crypto {
+
+//! XXH64 hash calculation
+struct xxh64 : public checksum_base<xxh64> {
+	
+	void init(boost::uint64_t seed = 0);
+	
+	void update(const char * data, size_t length);
+	
+	boost::uint64_t finalize() const;
+	
+private:
+	
+	static const size_t block_size = 32;
+	
+	boost::uint64_t seed;
+	boost::uint64_t state[4];
+	boost::uint64_t total;
+	
+	char buffer[block_size];
+	size_t buffered;
+	
+};
+
+} // namespace crypto
+
+#endif // INNOEXTRACT_CRYPTO_XXHASH_HPP
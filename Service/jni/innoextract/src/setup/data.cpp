@@ -29,7 +29,19 @@
 
 namespace setup {
 
-void data_entry::load(std::istream & is, const version & version) {
+void data_entry::load(util::cursor & is, const version & version) {
+	
+	// Setups since 5.3.9 all store the same fields
+	if(version >= INNO_VERSION(5, 3, 9)) {
+		load_fields(is, version_since<INNO_VERSION(5, 3, 9)>(version));
+	} else {
+		load_fields(is, version);
+	}
+	
+}
+
+template <class Version>
+void data_entry::load_fields(util::cursor & is, const Version & version) {
 	
 	chunk.first_slice = util::load<boost::uint32_t>(is, version.bits);
 	chunk.last_slice = util::load<boost::uint32_t>(is, version.bits);
@@ -59,10 +71,10 @@ void data_entry::load(std::istream & is, const version & version) {
 	}
 	
 	if(version >= INNO_VERSION(5, 3, 9)) {
-		is.read(file.checksum.sha1, std::streamsize(sizeof(file.checksum.sha1)));
+		is.read(file.checksum.sha1, sizeof(file.checksum.sha1));
 		file.checksum.type = crypto::SHA1;
 	} else if(version >= INNO_VERSION(4, 2, 0)) {
-		is.read(file.checksum.md5, std::streamsize(sizeof(file.checksum.md5)));
+		is.read(file.checksum.md5, sizeof(file.checksum.md5));
 		file.checksum.type = crypto::MD5;
 	} else if(version >= INNO_VERSION(4, 0, 1)) {
 		file.checksum.crc32 = util::load<boost::uint32_t>(is);
@@ -27,7 +27,6 @@
 #define INNOEXTRACT_SETUP_DATA_HPP
 
 #include <stddef.h>
-#include <iosfwd>
 
 #include <boost/cstdint.hpp>
 
@@ -37,6 +36,8 @@
 #include "util/enum.hpp"
 #include "util/flags.hpp"
 
+namespace util { class cursor; }
+
 namespace setup {
 
 struct version;
@@ -75,7 +76,12 @@ struct data_entry {
 	 *
 	 * \note This function may not be thread-safe on all operating systems.
 	 */
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
+	
+private:
+	
+	template <class Version>
+	void load_fields(util::cursor & is, const Version & version);
 	
 };
 
@@ -36,13 +36,13 @@ STORED_ENUM_MAP(delete_target_type_map, delete_entry::Files,
 
 } // anonymous namespace
 
-void delete_entry::load(std::istream & is, const version & version) {
+void delete_entry::load(util::cursor & is, const version & version) {
 	
 	if(version < INNO_VERSION(1, 3, 21)) {
 		(void)util::load<boost::uint32_t>(is); // uncompressed size of the entry
 	}
 	
-	is >> util::encoded_string(name, version.codepage());
+	is >> util::encoded_lazy_string(name, version.codepage());
 	
 	load_condition_data(is, version);
 	
@@ -26,11 +26,11 @@
 #ifndef INNOEXTRACT_SETUP_DELETE_HPP
 #define INNOEXTRACT_SETUP_DELETE_HPP
 
-#include <string>
-#include <iosfwd>
-
 #include "setup/item.hpp"
 #include "util/enum.hpp"
+#include "util/lazy_string.hpp"
+
+namespace util { class cursor; }
 
 namespace setup {
 
@@ -44,11 +44,11 @@ struct delete_entry : public item {
 		DirIfEmpty,
 	};
 	
-	std::string name;
+	util::lazy_string name;
 	
 	target_type type;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
@@ -45,7 +45,7 @@ STORED_FLAGS_MAP(stored_inno_directory_options_1,
 
 } // anonymous namespace
 
-void directory_entry::load(std::istream & is, const version & version) {
+void directory_entry::load(util::cursor & is, const version & version) {
 	
 	if(version < INNO_VERSION(1, 3, 21)) {
 		(void)util::load<boost::uint32_t>(is); // uncompressed size of the entry
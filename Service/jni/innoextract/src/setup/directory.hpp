@@ -27,7 +27,6 @@
 #define INNOEXTRACT_SETUP_DIRECTORY_HPP
 
 #include <string>
-#include <iosfwd>
 
 #include <boost/cstdint.hpp>
 
@@ -35,6 +34,8 @@
 #include "util/enum.hpp"
 #include "util/flags.hpp"
 
+namespace util { class cursor; }
+
 namespace setup {
 
 struct version;
@@ -58,7 +59,7 @@ struct directory_entry : public item {
 	
 	flags options;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
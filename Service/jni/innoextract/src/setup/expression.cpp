@@ -25,6 +25,7 @@
 #include <vector>
 #include <stdexcept>
 
+#include "util/arena.hpp"
 #include "util/log.hpp"
 
 namespace setup {
@@ -53,10 +54,11 @@ struct evaluator {
 		paren_right,
 		identifier
 	} token;
-	std::string token_str;
+	const char * token_start;
+	size_t token_size;
 	
-	evaluator(const std::string & expr, const std::string & test)
-		: test(test), expr(expr.c_str()), token(end) { }
+	evaluator(const char * expr, const std::string & test)
+		: test(test), expr(expr), token(end), token_start(NULL), token_size(0) { }
 	
 	token_type next() {
 		
@@ -89,7 +91,8 @@ struct evaluator {
 				return (token = op_or);
 			}
 			
-			return (token_str.assign(start, expr), token = identifier);
+			token_start = start, token_size = size_t(expr - start);
+			return (token = identifier);
 			
 		} else {
 			throw std::runtime_error(std::string("unexpected symbol: ") + *expr);
@@ -97,7 +100,8 @@ struct evaluator {
 	}
 	
 	bool eval_identifier(bool lazy) {
-		bool result = lazy || token_str == test;
+		bool result = lazy || (token_size == test.size()
+		                       && !memcmp(token_start, test.data(), token_size));
 		next();
 		return result;
 	}
@@ -125,7 +129,9 @@ struct evaluator {
 		bool result = eval_factor(lazy);
 		while(token == op_and) {
 			next();
-			result = result && eval_factor(lazy || !result);
+			// Always evaluate the operand to consume its tokens
+			bool operand = eval_factor(lazy || !result);
+			result = result && operand;
 		}
 		return result;
 	}
@@ -136,7 +142,8 @@ struct evaluator {
 			if(token == op_or) {
 				next();
 			}
-			result = result || eval_term(lazy || result);
+			bool operand = eval_term(lazy || result);
+			result = result || operand;
 		}
 		return result;
 	}
@@ -150,7 +157,7 @@ struct evaluator {
 
 } // anonymous namespace
 
-bool expression_match(const std::string & test, const std::string & expr) {
+bool expression_match(const std::string & test, const char * expr) {
 	try {
 		return evaluator(expr, test).eval();
 	} catch(const std::runtime_error & error) {
@@ -159,11 +166,22 @@ bool expression_match(const std::string & test, const std::string & expr) {
 	}
 }
 
-bool is_simple_expression(const std::string & expression) {
-	if(expression.empty()) {
+bool expression_matcher::match(const util::arena_string & expression) {
+	
+	std::pair<result_map::iterator, bool> result;
+	result = results_.insert(result_map::value_type(expression.c_str(), false));
+	if(result.second) {
+		result.first->second = expression_match(test_, expression.c_str());
+	}
+	
+	return result.first->second;
+}
+
+bool is_simple_expression(const char * expression) {
+	if(!*expression) {
 		return true;
 	}
-	const char * c = expression.c_str();
+	const char * c = expression;
 	if(!is_identifier_start(*c)) {
 		return false;
 	}
@@ -28,11 +28,45 @@
 
 #include <string>
 
+#include <boost/unordered_map.hpp>
+
+namespace util { class arena_string; }
+
 namespace setup {
 
-bool expression_match(const std::string & test, const std::string & expression);
+bool expression_match(const std::string & test, const char * expression);
+inline bool expression_match(const std::string & test, const std::string & expression) {
+	return expression_match(test, expression.c_str());
+}
+
+/*!
+ * Match many expressions against the same identifier, such as the selected language.
+ *
+ * The result for each expression is computed once and then looked up by the address of
+ * the expression string. Equal \ref util::arena::intern "interned" conditions share
+ * their address, so each distinct condition is only parsed and evaluated once.
+ * The expression strings must not be freed while the matcher is used.
+ */
+class expression_matcher {
+	
+	std::string test_;
+	
+	typedef boost::unordered_map<const char *, bool> result_map;
+	result_map results_;
+	
+public:
+	
+	explicit expression_matcher(const std::string & test) : test_(test) { }
+	
+	//! \return the same result as \ref expression_match for the identifier.
+	bool match(const util::arena_string & expression);
+	
+};
 
-bool is_simple_expression(const std::string & expression);
+bool is_simple_expression(const char * expression);
+inline bool is_simple_expression(const std::string & expression) {
+	return is_simple_expression(expression.c_str());
+}
 
 } // namespace setup
 
@@ -70,7 +70,19 @@ NAMES(setup::file_copy_mode, "File Copy Mode",
 
 namespace setup {
 
-void file_entry::load(std::istream & is, const version & version) {
+void file_entry::load(util::cursor & is, const version & version) {
+	
+	// Setups since 5.2.5 all store the same fields
+	if(version >= INNO_VERSION(5, 2, 5)) {
+		load_fields(is, version_since<INNO_VERSION(5, 2, 5)>(version));
+	} else {
+		load_fields(is, version);
+	}
+	
+}
+
+template <class Version>
+void file_entry::load_fields(util::cursor & is, const Version & version) {
 	
 	USE_ENUM_NAMES(file_copy_mode)
 	
@@ -80,11 +92,11 @@ void file_entry::load(std::istream & is, const version & version) {
 		(void)util::load<boost::uint32_t>(is); // uncompressed size of the entry
 	}
 	
-	is >> util::encoded_string(source, version.codepage());
+	is >> util::encoded_arena_string(source, version.codepage());
 	is >> util::encoded_string(destination, version.codepage());
-	is >> util::encoded_string(install_font_name, version.codepage());
+	is >> util::encoded_arena_string(install_font_name, version.codepage());
 	if(version >= INNO_VERSION(5, 2, 5)) {
-		is >> util::encoded_string(strong_assembly_name, version.codepage());
+		is >> util::encoded_arena_string(strong_assembly_name, version.codepage());
 	} else {
 		strong_assembly_name.clear();
 	}
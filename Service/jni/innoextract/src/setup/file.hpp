@@ -27,14 +27,16 @@
 #define INNOEXTRACT_SETUP_FILE_HPP
 
 #include <string>
-#include <iosfwd>
 
 #include <boost/cstdint.hpp>
 
 #include "setup/item.hpp"
+#include "util/arena.hpp"
 #include "util/enum.hpp"
 #include "util/flags.hpp"
 
+namespace util { class cursor; }
+
 namespace setup {
 
 struct version;
@@ -90,10 +92,10 @@ struct file_entry : public item {
 		ReadOnly = 0x1
 	};
 	
-	std::string source;
+	util::arena_string source;
 	std::string destination;
-	std::string install_font_name;
-	std::string strong_assembly_name;
+	util::arena_string install_font_name;
+	util::arena_string strong_assembly_name;
 	
 	boost::uint32_t location; //!< index into the data entry list
 	boost::uint32_t attributes;
@@ -105,7 +107,12 @@ struct file_entry : public item {
 	
 	file_type type;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
+	
+private:
+	
+	template <class Version>
+	void load_fields(util::cursor & is, const Version & version);
 	
 };
 
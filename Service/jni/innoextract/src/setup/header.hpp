@@ -29,7 +29,6 @@
 #include <stddef.h>
 #include <bitset>
 #include <string>
-#include <iosfwd>
 
 #include <boost/cstdint.hpp>
 
@@ -39,6 +38,8 @@
 #include "util/enum.hpp"
 #include "util/flags.hpp"
 
+namespace util { class cursor; }
+
 namespace setup {
 
 struct version;
@@ -259,7 +260,7 @@ struct header {
 	
 	flags options;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
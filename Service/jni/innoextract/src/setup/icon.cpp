@@ -36,23 +36,23 @@ STORED_ENUM_MAP(stored_close_setting, icon_entry::NoSetting,
 
 } // anonymous namespace
 
-void icon_entry::load(std::istream & is, const version & version) {
+void icon_entry::load(util::cursor & is, const version & version) {
 	
 	if(version < INNO_VERSION(1, 3, 21)) {
 		(void)util::load<boost::uint32_t>(is); // uncompressed size of the entry
 	}
 	
-	is >> util::encoded_string(name, version.codepage());
-	is >> util::encoded_string(filename, version.codepage());
-	is >> util::encoded_string(parameters, version.codepage());
-	is >> util::encoded_string(working_dir, version.codepage());
-	is >> util::encoded_string(icon_file, version.codepage());
-	is >> util::encoded_string(comment, version.codepage());
+	is >> util::encoded_lazy_string(name, version.codepage());
+	is >> util::encoded_lazy_string(filename, version.codepage());
+	is >> util::encoded_lazy_string(parameters, version.codepage());
+	is >> util::encoded_lazy_string(working_dir, version.codepage());
+	is >> util::encoded_lazy_string(icon_file, version.codepage());
+	is >> util::encoded_lazy_string(comment, version.codepage());
 	
 	load_condition_data(is, version);
 	
 	if(version >= INNO_VERSION(5, 3, 5)) {
-		is >> util::encoded_string(app_user_model_id, version.codepage());
+		is >> util::encoded_lazy_string(app_user_model_id, version.codepage());
 	} else {
 		app_user_model_id.clear();
 	}
@@ -26,14 +26,14 @@
 #ifndef INNOEXTRACT_SETUP_ICON_HPP
 #define INNOEXTRACT_SETUP_ICON_HPP
 
-#include <string>
-#include <iosfwd>
-
 #include <boost/cstdint.hpp>
 
 #include "setup/item.hpp"
 #include "util/enum.hpp"
 #include "util/flags.hpp"
+#include "util/lazy_string.hpp"
+
+namespace util { class cursor; }
 
 namespace setup {
 
@@ -58,13 +58,13 @@ struct icon_entry : public item {
 		DontCloseOnExit,
 	};
 	
-	std::string name;
-	std::string filename;
-	std::string parameters;
-	std::string working_dir;
-	std::string icon_file;
-	std::string comment;
-	std::string app_user_model_id;
+	util::lazy_string name;
+	util::lazy_string filename;
+	util::lazy_string parameters;
+	util::lazy_string working_dir;
+	util::lazy_string icon_file;
+	util::lazy_string comment;
+	util::lazy_string app_user_model_id;
 	
 	int icon_index;
 	
@@ -76,7 +76,7 @@ struct icon_entry : public item {
 	
 	flags options;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
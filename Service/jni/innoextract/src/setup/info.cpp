@@ -20,9 +20,18 @@
 
 #include "setup/info.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <istream>
 
+#include "configure.hpp"
+
+#if INNOEXTRACT_HAVE_STD_THREAD
+#include <exception>
+#include <functional>
+#include <thread>
+#endif
+
 #include <boost/foreach.hpp>
 
 #include "setup/component.hpp"
@@ -51,46 +60,161 @@ namespace {
 struct no_arg { };
 
 template <class Entry, class Arg>
-static void load_entry(std::istream & is, const setup::version & version,
-                       Entry & entity, Arg arg) {
+static void load_entry(util::cursor & is, const setup::version & version,
+                       Entry & entity, const Arg & arg) {
 	entity.load(is, version, arg);
 }
 template <class Entry>
-static void load_entry(std::istream & is, const setup::version & version,
-                                    Entry & entity, no_arg arg) {
+static void load_entry(util::cursor & is, const setup::version & version,
+                                    Entry & entity, const no_arg & arg) {
 	(void)arg;
 	entity.load(is, version);
 }
 
+#if INNOEXTRACT_HAVE_STD_THREAD
+
+//! Minimum number of entries to decode on each thread.
+const size_t min_entries_per_thread = 256;
+
+//! Maximum number of threads to decode entries with.
+const size_t max_decode_threads = 8;
+
+//! Decodes a range of entries whose positions have already been found.
+template <class Entry, class Arg>
+struct entry_decoder {
+	
+	const setup::version & version;
+	std::vector<Entry> & entries;
+	const std::vector<const char *> & starts; //!< Start of each entry, followed by the end.
+	const Arg & arg;
+	
+	entry_decoder(const setup::version & v, std::vector<Entry> & e,
+	              const std::vector<const char *> & s, const Arg & a)
+		: version(v), entries(e), starts(s), arg(a) { }
+	
+	void operator()(size_t begin, size_t end, util::arena * pool,
+	                std::exception_ptr * error) const {
+		try {
+			util::cursor is(starts[begin], size_t(starts[end] - starts[begin]));
+			is.set_arena(pool);
+			for(size_t i = begin; i < end; i++) {
+				load_entry(is, version, entries[i], arg);
+			}
+		} catch(...) {
+			*error = std::current_exception();
+		}
+	}
+	
+};
+
+/*!
+ * Load entries in two passes: first find where each entry starts, then decode ranges
+ * of entries on multiple threads.
+ *
+ * \return \c false if there are too few entries to make this worthwhile.
+ */
+template <class Entry, class Arg>
+static bool load_entries_parallel(util::cursor & is, const setup::version & version,
+                                  size_t count, std::vector<Entry> & entries,
+                                  const Arg & arg) {
+	
+	size_t thread_count = std::min(size_t(std::thread::hardware_concurrency()),
+	                               max_decode_threads);
+	thread_count = std::min(thread_count, count / min_entries_per_thread);
+	if(thread_count < 2) {
+		return false;
+	}
+	
+	// Strings are skipped without copying or converting them, so this pass is cheap
+	std::vector<const char *> starts;
+	starts.reserve(count + 1);
+	{
+		// Warnings are logged when the entries are decoded below
+		logger::mute mute;
+		Entry entry;
+		is.skip_strings(true);
+		for(size_t i = 0; i < count; i++) {
+			starts.push_back(is.position());
+			load_entry(is, version, entry, arg);
+		}
+		is.skip_strings(false);
+		starts.push_back(is.position());
+	}
+	
+	// Arenas can only be used by one thread, so give each other thread a child arena
+	util::arena * pool = is.get_arena();
+	
+	entries.resize(count);
+	entry_decoder<Entry, Arg> decoder(version, entries, starts, arg);
+	std::vector<std::exception_ptr> errors(thread_count);
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	size_t started = 1;
+	try {
+		for(; started < thread_count; started++) {
+			threads.push_back(std::thread(std::cref(decoder), count * started / thread_count,
+			                              count * (started + 1) / thread_count,
+			                              pool ? &pool->child() : NULL, &errors[started]));
+		}
+	} catch(...) {
+		// Thread limits are easily reached on some systems - decode the rest on this thread
+	}
+	decoder(0, count / thread_count, pool, &errors[0]);
+	if(started < thread_count) {
+		decoder(count * started / thread_count, count, pool, &errors[started]);
+	}
+	for(size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+	
+	for(size_t i = 0; i < errors.size(); i++) {
+		if(errors[i]) {
+			std::rethrow_exception(errors[i]);
+		}
+	}
+	
+	return true;
+}
+
+#endif // INNOEXTRACT_HAVE_STD_THREAD
+
 template <class Entry, class Arg>
-static void load_entries(std::istream & is, const setup::version & version,
+static void load_entries(util::cursor & is, const setup::version & version,
                   info::entry_types entry_types, size_t count,
                   std::vector<Entry> & entries, info::entry_types::enum_type entry_type,
-                  Arg arg = Arg()) {
+                  const Arg & arg = Arg()) {
 	
 	entries.clear();
 	if(entry_types & entry_type) {
+		#if INNOEXTRACT_HAVE_STD_THREAD
+		if(load_entries_parallel(is, version, count, entries, arg)) {
+			return;
+		}
+		#endif
 		entries.resize(count);
 		for(size_t i = 0; i < count; i++) {
 			Entry & entry = entries[i];
 			load_entry(is, version, entry, arg);
 		}
 	} else {
+		// Only step over the entries: strings are skipped without copying or converting them
+		Entry entry;
+		is.skip_strings(true);
 		for(size_t i = 0; i < count; i++) {
-			Entry entry;
 			load_entry(is, version, entry, arg);
 		}
+		is.skip_strings(false);
 	}
 }
 
 template <class Entry>
-static void load_entries(std::istream & is, const setup::version & version,
+static void load_entries(util::cursor & is, const setup::version & version,
                   info::entry_types entry_types, size_t count,
                   std::vector<Entry> & entries, info::entry_types::enum_type entry_type) {
 	load_entries<Entry, no_arg>(is, version, entry_types, count, entries, entry_type);
 }
 
-static void load_wizard_and_decompressor(std::istream & is, const setup::version & version,
+static void load_wizard_and_decompressor(util::cursor & is, const setup::version & version,
                                         const setup::header & header,
                                         setup::info & info, info::entry_types entries) {
 	
@@ -136,61 +260,83 @@ static void load_wizard_and_decompressor(std::istream & is, const setup::version
 
 } // anonymous namespace
 
-static void check_is_end(stream::block_reader::pointer & is, const char * what) {
-	is->exceptions(std::ios_base::goodbit);
-	char dummy;
-	if(!is->get(dummy).eof()) {
+static void check_is_end(const util::cursor & is, const char * what) {
+	if(!is.empty()) {
 		throw std::ios_base::failure(what);
 	}
 }
 
+static void read_blocks(std::istream & is, const setup::version & version,
+                        std::string & primary, std::string & secondary) {
+	stream::block_reader::read(is, version, primary);
+	stream::block_reader::read(is, version, secondary);
+}
+
 void info::load(std::istream & ifs, entry_types e, const setup::version & v) {
 	
+	std::string primary, secondary;
+	read_blocks(ifs, v, primary, secondary);
+	
+	load(primary, secondary, e, v);
+}
+
+void info::load(const std::string & primary, const std::string & secondary,
+                entry_types e, const setup::version & v) {
+	
 	if(e & (Messages | NoSkip)) {
 		e |= Languages;
 	}
 	
-	stream::block_reader::pointer is = stream::block_reader::get(ifs, v);
+	strings.clear();
 	
-	header.load(*is, v);
+	util::cursor is(primary);
+	is.set_arena(&strings);
 	
-	load_entries(*is, v, e, header.language_count, languages, Languages);
+	header.load(is, v);
+	
+	load_entries(is, v, e, header.language_count, languages, Languages);
 	
 	if(v < INNO_VERSION(4, 0, 0)) {
-		load_wizard_and_decompressor(*is, v, header, *this, e);
-	}
-	
-	load_entries(*is, v, e, header.message_count, messages, Messages, languages);
-	load_entries(*is, v, e, header.permission_count, permissions, Permissions);
-	load_entries(*is, v, e, header.type_count, types, Types);
-	load_entries(*is, v, e, header.component_count, components, Components);
-	load_entries(*is, v, e, header.task_count, tasks, Tasks);
-	load_entries(*is, v, e, header.directory_count, directories, Directories);
-	load_entries(*is, v, e, header.file_count, files, Files);
-	load_entries(*is, v, e, header.icon_count, icons, Icons);
-	load_entries(*is, v, e, header.ini_entry_count, ini_entries, IniEntries);
-	load_entries(*is, v, e, header.registry_entry_count, registry_entries, RegistryEntries);
-	load_entries(*is, v, e, header.delete_entry_count, delete_entries, DeleteEntries);
-	load_entries(*is, v, e, header.uninstall_delete_entry_count, uninstall_delete_entries,
+		load_wizard_and_decompressor(is, v, header, *this, e);
+	}
+	
+	load_entries(is, v, e, header.message_count, messages, Messages, languages);
+	load_entries(is, v, e, header.permission_count, permissions, Permissions);
+	load_entries(is, v, e, header.type_count, types, Types);
+	load_entries(is, v, e, header.component_count, components, Components);
+	load_entries(is, v, e, header.task_count, tasks, Tasks);
+	load_entries(is, v, e, header.directory_count, directories, Directories);
+	load_entries(is, v, e, header.file_count, files, Files);
+	load_entries(is, v, e, header.icon_count, icons, Icons);
+	load_entries(is, v, e, header.ini_entry_count, ini_entries, IniEntries);
+	load_entries(is, v, e, header.registry_entry_count, registry_entries, RegistryEntries);
+	load_entries(is, v, e, header.delete_entry_count, delete_entries, DeleteEntries);
+	load_entries(is, v, e, header.uninstall_delete_entry_count, uninstall_delete_entries,
 	             UninstallDeleteEntries);
-	load_entries(*is, v, e, header.run_entry_count, run_entries, RunEntries);
-	load_entries(*is, v, e, header.uninstall_run_entry_count, uninstall_run_entries,
+	load_entries(is, v, e, header.run_entry_count, run_entries, RunEntries);
+	load_entries(is, v, e, header.uninstall_run_entry_count, uninstall_run_entries,
 	             UninstallRunEntries);
 	
 	if(v >= INNO_VERSION(4, 0, 0)) {
-		load_wizard_and_decompressor(*is, v, header, *this, e);
+		load_wizard_and_decompressor(is, v, header, *this, e);
 	}
 	
-	// restart the compression stream
 	check_is_end(is, "unknown data at end of primary header stream");
-	is = stream::block_reader::get(ifs, v);
+	is = util::cursor(secondary);
+	is.set_arena(&strings);
 	
-	load_entries(*is, v, e, header.data_entry_count, data_entries, DataEntries);
+	load_entries(is, v, e, header.data_entry_count, data_entries, DataEntries);
 	
 	check_is_end(is, "unknown data at end of secondary header stream");
 }
 
 void info::load(std::istream & is, entry_types entries) {
+	std::string primary, secondary;
+	load(is, entries, primary, secondary);
+}
+
+void info::load(std::istream & is, entry_types entries,
+                std::string & primary, std::string & secondary) {
 	
 	version.load(is);
 	
@@ -208,10 +354,16 @@ void info::load(std::istream & is, entry_types entries) {
 		// Force parsing all headers so that we don't miss any errors.
 		entries |= NoSkip;
 	}
+	// The headers are only decompressed again if the next candidate version stores
+	// them differently - otherwise the same data is parsed again.
+	bool decompressed = false;
 	if(!version.known || ambiguous) {
 		std::ios_base::streampos start = is.tellg();
+		setup::version candidate = version;
 		try {
-			load(is, entries, version);
+			read_blocks(is, version, primary, secondary);
+			decompressed = true;
+			load(primary, secondary, entries, version);
 			return;
 		} catch(...) {
 			version.value = version.next();
@@ -219,13 +371,19 @@ void info::load(std::istream & is, entry_types entries) {
 				version.value = listed_version;
 				throw;
 			}
+		}
+		if(!decompressed || !stream::block_reader::same_format(candidate, version)) {
+			decompressed = false;
 			is.clear();
 			is.seekg(start);
 		}
 	}
 	
 	try {
-		load(is, entries, version);
+		if(!decompressed) {
+			read_blocks(is, version, primary, secondary);
+		}
+		load(primary, secondary, entries, version);
 	} catch(...) {
 		version.value = listed_version;
 		throw;
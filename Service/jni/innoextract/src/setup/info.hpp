@@ -26,11 +26,13 @@
 #ifndef INNOEXTRACT_SETUP_INFO_HPP
 #define INNOEXTRACT_SETUP_INFO_HPP
 
+#include <string>
 #include <vector>
 #include <iosfwd>
 
 #include "setup/header.hpp"
 #include "setup/version.hpp"
+#include "util/arena.hpp"
 #include "util/flags.hpp"
 
 namespace setup {
@@ -115,6 +117,9 @@ struct info {
 	//! Loading enabled by \c DecryptDll
 	std::string decrypt_dll;
 	
+	//! Storage for the \ref util::arena_string members of the loaded entries.
+	util::arena strings;
+	
 	/*!
 	 * Load setup headers.
 	 *
@@ -126,6 +131,22 @@ struct info {
 	 */
 	void load(std::istream & is, entry_types entries);
 	
+	/*!
+	 * Load setup headers and keep the decompressed block streams.
+	 *
+	 * \param is        The input stream to load the setup headers from, positioned as
+	 *                  for \ref load(std::istream &, entry_types).
+	 * \param entries   What kinds of entries to load.
+	 * \param primary   Receives the contents of the first block stream.
+	 * \param secondary Receives the contents of the second block stream.
+	 *
+	 * The block streams can later be passed to
+	 * \ref load(const std::string &, const std::string &, entry_types, const setup::version &)
+	 * together with the detected \ref version.
+	 */
+	void load(std::istream & is, entry_types entries,
+	          std::string & primary, std::string & secondary);
+	
 	/*!
 	 * Load setup headers for a specific version.
 	 *
@@ -141,6 +162,20 @@ struct info {
 	 */
 	void load(std::istream & is, entry_types entries, const setup::version & version);
 	
+	/*!
+	 * Load setup headers for a specific version from already decompressed block streams.
+	 *
+	 * \param primary   Contents of the first block stream, which contains all entries
+	 *                  except the data entries.
+	 * \param secondary Contents of the second block stream with the data entries.
+	 * \param entries   What kinds of entries to load.
+	 * \param version   The setup data version of the headers.
+	 *
+	 * This function does not set the \ref version member.
+	 */
+	void load(const std::string & primary, const std::string & secondary,
+	          entry_types entries, const setup::version & version);
+	
 };
 
 } // namespace setup
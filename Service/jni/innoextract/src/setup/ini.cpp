@@ -38,21 +38,24 @@ STORED_FLAGS_MAP(stored_ini_flags,
 	ini_entry::HasValue,
 );
 
+const char default_inifile[] = "{windows}/WIN.INI";
+
 } // anonymous namespace
 
-void ini_entry::load(std::istream & is, const version & version) {
+void ini_entry::load(util::cursor & is, const version & version) {
 	
 	if(version < INNO_VERSION(1, 3, 21)) {
 		(void)util::load<boost::uint32_t>(is); // uncompressed size of the entry
 	}
 	
-	is >> util::encoded_string(inifile, version.codepage());
-	if(inifile.empty()) {
-		inifile = "{windows}/WIN.INI";
+	is >> util::encoded_lazy_string(inifile, version.codepage());
+	if(inifile.empty() && !is.skips_strings()) {
+		size_t size = sizeof(default_inifile) - 1;
+		inifile = util::lazy_string(util::arena_string::reference(default_inifile, size));
 	}
-	is >> util::encoded_string(section, version.codepage());
-	is >> util::encoded_string(key, version.codepage());
-	is >> util::encoded_string(value, version.codepage());
+	is >> util::encoded_lazy_string(section, version.codepage());
+	is >> util::encoded_lazy_string(key, version.codepage());
+	is >> util::encoded_lazy_string(value, version.codepage());
 	
 	load_condition_data(is, version);
 	
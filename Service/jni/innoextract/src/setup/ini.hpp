@@ -26,12 +26,12 @@
 #ifndef INNOEXTRACT_SETUP_INI_HPP
 #define INNOEXTRACT_SETUP_INI_HPP
 
-#include <string>
-#include <iosfwd>
-
 #include "setup/item.hpp"
 #include "util/enum.hpp"
 #include "util/flags.hpp"
+#include "util/lazy_string.hpp"
+
+namespace util { class cursor; }
 
 namespace setup {
 
@@ -47,14 +47,14 @@ struct ini_entry : public item {
 		HasValue
 	);
 	
-	std::string inifile;
-	std::string section;
-	std::string key;
-	std::string value;
+	util::lazy_string inifile;
+	util::lazy_string section;
+	util::lazy_string key;
+	util::lazy_string value;
 	
 	flags options;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
@@ -25,28 +25,29 @@
 
 namespace setup {
 
-void item::load_condition_data(std::istream & is, const version & version) {
+void item::load_condition_data(util::cursor & is, const version & version) {
 	
+	// Conditions are shared by many entries - intern them so they can be matched by address
 	if(version >= INNO_VERSION(2, 0, 0)) {
-		is >> util::encoded_string(components, version.codepage());
-		is >> util::encoded_string(tasks, version.codepage());
+		is >> util::encoded_arena_string(components, version.codepage(), true);
+		is >> util::encoded_arena_string(tasks, version.codepage(), true);
 	} else {
 		components.clear(), tasks.clear();
 	}
 	if(version >= INNO_VERSION(4, 0, 1)) {
-		is >> util::encoded_string(languages, version.codepage());
+		is >> util::encoded_arena_string(languages, version.codepage(), true);
 	} else {
 		languages.clear();
 	}
 	if(version >= INNO_VERSION_EXT(3, 0, 6, 1)) {
-		is >> util::encoded_string(check, version.codepage());
+		is >> util::encoded_lazy_string(check, version.codepage());
 	} else {
 		check.clear();
 	}
 	
 	if(version >= INNO_VERSION(4, 1, 0)) {
-		is >> util::encoded_string(after_install, version.codepage());
-		is >> util::encoded_string(before_install, version.codepage());
+		is >> util::encoded_lazy_string(after_install, version.codepage());
+		is >> util::encoded_lazy_string(before_install, version.codepage());
 	} else {
 		after_install.clear(), before_install.clear();
 	}
@@ -26,10 +26,11 @@
 #ifndef INNOEXTRACT_SETUP_ITEM_HPP
 #define INNOEXTRACT_SETUP_ITEM_HPP
 
-#include <string>
-#include <iosfwd>
-
 #include "setup/windows.hpp"
+#include "util/arena.hpp"
+#include "util/lazy_string.hpp"
+
+namespace util { class cursor; }
 
 namespace setup {
 
@@ -37,21 +38,22 @@ struct version;
 
 struct item {
 	
-	std::string components;
-	std::string tasks;
-	std::string languages;
-	std::string check;
+	// Stored in the arena of the \ref setup::info the item was loaded into
+	util::arena_string components;
+	util::arena_string tasks;
+	util::arena_string languages;
+	util::lazy_string check;
 	
-	std::string after_install;
-	std::string before_install;
+	util::lazy_string after_install;
+	util::lazy_string before_install;
 	
 	windows_version_range winver;
 	
 protected:
 	
-	void load_condition_data(std::istream & is, const version & version);
+	void load_condition_data(util::cursor & is, const version & version);
 	
-	void load_version_data(std::istream & is, const version & version) {
+	void load_version_data(util::cursor & is, const version & version) {
 		winver.load(is, version);
 	}
 	
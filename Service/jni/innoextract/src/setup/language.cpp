@@ -25,7 +25,7 @@
 
 namespace setup {
 
-void language_entry::load(std::istream & is, const version & version) {
+void language_entry::load(util::cursor & is, const version & version) {
 	
 	if(version >= INNO_VERSION(4, 0, 0)) {
 		is >> util::encoded_string(name, version.codepage());
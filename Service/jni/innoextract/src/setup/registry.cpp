@@ -58,7 +58,7 @@ STORED_ENUM_MAP(stored_registry_entry_type_2, registry_entry::None,
 
 } // anonymous namespace
 
-void registry_entry::load(std::istream & is, const version & version) {
+void registry_entry::load(util::cursor & is, const version & version) {
 	
 	if(version < INNO_VERSION(1, 3, 21)) {
 		(void)util::load<boost::uint32_t>(is); // uncompressed size of the entry
@@ -70,12 +70,12 @@ void registry_entry::load(std::istream & is, const version & version) {
 	} else {
 		name.clear();
 	}
-	is >> util::encoded_string(value, version.codepage());
+	is >> util::encoded_lazy_string(value, version.codepage());
 	
 	load_condition_data(is, version);
 	
 	if(version >= INNO_VERSION(4, 0, 11) && version < INNO_VERSION(4, 1, 0)) {
-		is >> util::encoded_string(permissions, version.codepage());
+		is >> util::encoded_lazy_string(permissions, version.codepage());
 	} else {
 		permissions.clear();
 	}
@@ -27,12 +27,14 @@
 #define INNOEXTRACT_SETUP_REGISTRY_HPP
 
 #include <string>
-#include <iosfwd>
 
 #include "setup/item.hpp"
 #include "setup/windows.hpp"
 #include "util/enum.hpp"
 #include "util/flags.hpp"
+#include "util/lazy_string.hpp"
+
+namespace util { class cursor; }
 
 namespace setup {
 
@@ -78,9 +80,9 @@ struct registry_entry : public item {
 	
 	std::string key;
 	std::string name; // empty string means (Default) key
-	std::string value;
+	util::lazy_string value;
 	
-	std::string permissions;
+	util::lazy_string permissions;
 	
 	hive_name hive;
 	
@@ -90,7 +92,7 @@ struct registry_entry : public item {
 	
 	flags options;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
@@ -38,32 +38,32 @@ STORED_ENUM_MAP(stored_run_wait_condition, run_entry::WaitUntilTerminated,
 
 } // anonymous namespace
 
-void run_entry::load(std::istream & is, const version & version) {
+void run_entry::load(util::cursor & is, const version & version) {
 	
 	if(version < INNO_VERSION(1, 3, 21)) {
 		(void)util::load<boost::uint32_t>(is); // uncompressed size of the entry
 	}
 	
-	is >> util::encoded_string(name, version.codepage());
-	is >> util::encoded_string(parameters, version.codepage());
-	is >> util::encoded_string(working_dir, version.codepage());
+	is >> util::encoded_lazy_string(name, version.codepage());
+	is >> util::encoded_lazy_string(parameters, version.codepage());
+	is >> util::encoded_lazy_string(working_dir, version.codepage());
 	if(version >= INNO_VERSION(1, 3, 21)) {
-		is >> util::encoded_string(run_once_id, version.codepage());
+		is >> util::encoded_lazy_string(run_once_id, version.codepage());
 	} else {
 		run_once_id.clear();
 	}
 	if(version >= INNO_VERSION(2, 0, 2)) {
-		is >> util::encoded_string(status_message, version.codepage());
+		is >> util::encoded_lazy_string(status_message, version.codepage());
 	} else {
 		status_message.clear();
 	}
 	if(version >= INNO_VERSION(5, 1, 13)) {
-		is >> util::encoded_string(verb, version.codepage());
+		is >> util::encoded_lazy_string(verb, version.codepage());
 	} else {
 		verb.clear();
 	}
 	if(version >= INNO_VERSION(2, 0, 0)) {
-		is >> util::encoded_string(description, version.codepage());
+		is >> util::encoded_lazy_string(description, version.codepage());
 	}
 	
 	load_condition_data(is, version);
@@ -26,12 +26,12 @@
 #ifndef INNOEXTRACT_SETUP_RUN_HPP
 #define INNOEXTRACT_SETUP_RUN_HPP
 
-#include <string>
-#include <iosfwd>
-
 #include "setup/item.hpp"
 #include "util/enum.hpp"
 #include "util/flags.hpp"
+#include "util/lazy_string.hpp"
+
+namespace util { class cursor; }
 
 namespace setup {
 
@@ -58,13 +58,13 @@ struct run_entry : public item {
 		WaitUntilIdle,
 	};
 	
-	std::string name;
-	std::string parameters;
-	std::string working_dir;
-	std::string run_once_id;
-	std::string status_message;
-	std::string verb;
-	std::string description;
+	util::lazy_string name;
+	util::lazy_string parameters;
+	util::lazy_string working_dir;
+	util::lazy_string run_once_id;
+	util::lazy_string status_message;
+	util::lazy_string verb;
+	util::lazy_string description;
 	
 	int show_command;
 	
@@ -72,7 +72,7 @@ struct run_entry : public item {
 	
 	flags options;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
@@ -27,12 +27,13 @@
 #define INNOEXTRACT_SETUP_TASK_HPP
 
 #include <string>
-#include <iosfwd>
 
 #include "setup/windows.hpp"
 #include "util/enum.hpp"
 #include "util/flags.hpp"
 
+namespace util { class cursor; }
+
 namespace setup {
 
 struct version;
@@ -63,7 +64,7 @@ struct task_entry {
 	
 	flags options;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
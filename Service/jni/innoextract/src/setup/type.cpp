@@ -51,7 +51,7 @@ NAMED_FLAGS(setup::type_flags)
 
 namespace setup {
 
-void type_entry::load(std::istream & is, const version & version) {
+void type_entry::load(util::cursor & is, const version & version) {
 	
 	USE_FLAG_NAMES(setup::type_flags)
 	
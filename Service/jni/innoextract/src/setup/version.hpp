@@ -88,6 +88,45 @@ struct version {
 
 std::ostream & operator<<(std::ostream & os, const version & version);
 
+/*!
+ * Version of a setup that is known to be at least \c Minimum.
+ *
+ * This can be used in place of \ref version to instantiate loaders that are templated on
+ * the version type for one family of setup data formats: comparisons with versions up to
+ * \c Minimum are resolved at compile time, so the instantiated loader only checks for
+ * newer versions at runtime.
+ */
+template <version_constant Minimum>
+struct version_since {
+	
+	const setup::version & base;
+	
+	boost::uint8_t bits;
+	
+	bool unicode;
+	
+	explicit version_since(const setup::version & version)
+		: base(version), bits(version.bits), unicode(version.unicode) { }
+	
+	boost::uint32_t codepage() const { return base.codepage(); }
+	
+	operator const setup::version &() const { return base; }
+	
+	bool operator>=(version_constant other) const {
+		return other <= Minimum || base.value >= other;
+	}
+	bool operator>(version_constant other) const {
+		return other < Minimum || base.value > other;
+	}
+	bool operator<(version_constant other) const { return !(*this >= other); }
+	bool operator<=(version_constant other) const { return !(*this > other); }
+	bool operator==(version_constant other) const {
+		return other >= Minimum && base.value == other;
+	}
+	bool operator!=(version_constant other) const { return !(*this == other); }
+	
+};
+
 } // namespace setup
 
 #endif // INNOEXTRACT_SETUP_VERSION_HPP
@@ -32,7 +32,7 @@ namespace setup {
 
 const windows_version windows_version::none = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0 } };
 
-void windows_version::data::load(std::istream & is, const version & version) {
+void windows_version::data::load(util::cursor & is, const version & version) {
 	
 	if(version >= INNO_VERSION(1, 3, 21)) {
 		build = util::load<boost::uint16_t>(is);
@@ -45,7 +45,7 @@ void windows_version::data::load(std::istream & is, const version & version) {
 	
 }
 
-void windows_version::load(std::istream & is, const version & version) {
+void windows_version::load(util::cursor & is, const version & version) {
 	
 	win_version.load(is, version);
 	nt_version.load(is, version);
@@ -59,7 +59,7 @@ void windows_version::load(std::istream & is, const version & version) {
 	
 }
 
-void windows_version_range::load(std::istream & is, const version & version) {
+void windows_version_range::load(util::cursor & is, const version & version) {
 	begin.load(is, version);
 	end.load(is, version);
 }
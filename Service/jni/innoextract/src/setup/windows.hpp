@@ -28,6 +28,8 @@
 
 #include <iosfwd>
 
+namespace util { class cursor; }
+
 namespace setup {
 
 struct version;
@@ -48,7 +50,7 @@ struct windows_version {
 			return !(*this == o);
 		}
 		
-		void load(std::istream & is, const version & version);
+		void load(util::cursor & is, const version & version);
 		
 	};
 	
@@ -72,7 +74,7 @@ struct windows_version {
 	
 	service_pack nt_service_pack;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 	bool operator==(const windows_version & o) const {
 		return (win_version == o.win_version
@@ -93,7 +95,7 @@ struct windows_version_range {
 	windows_version begin;
 	windows_version end;
 	
-	void load(std::istream & is, const version & version);
+	void load(util::cursor & is, const version & version);
 	
 };
 
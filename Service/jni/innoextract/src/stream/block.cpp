@@ -211,4 +211,31 @@ block_reader::pointer block_reader::get(std::istream & base, const setup::versio
 	return pointer(fis.release());
 }
 
+void block_reader::read(std::istream & base, const setup::version & version,
+                        std::string & target) {
+	
+	pointer is = get(base, version);
+	
+	// Reaching the end of the stream is expected here
+	is->exceptions(std::ios_base::badbit);
+	
+	target.clear();
+	size_t size = 0;
+	for(;;) {
+		size_t n = std::max(size, size_t(64 * 1024));
+		target.resize(size + n);
+		size_t count = size_t(is->read(&target[size], std::streamsize(n)).gcount());
+		size += count;
+		if(count != n) {
+			break;
+		}
+	}
+	target.resize(size);
+}
+
+bool block_reader::same_format(const setup::version & a, const setup::version & b) {
+	return (a >= INNO_VERSION(4, 0, 9)) == (b >= INNO_VERSION(4, 0, 9))
+	       && (a >= INNO_VERSION(4, 1, 6)) == (b >= INNO_VERSION(4, 1, 6));
+}
+
 } // namespace stream
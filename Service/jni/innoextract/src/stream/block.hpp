@@ -80,6 +80,25 @@ public:
 	 */
 	static pointer get(std::istream & base, const setup::version & version);
 	
+	/*!
+	 * Read and decompress a complete block stream into memory.
+	 *
+	 * \param base    The input stream for the main setup files, positioned as for \ref get.
+	 * \param version The version of the setup data.
+	 * \param target  Receives the uncompressed headers.
+	 *
+	 * \throws block_error if a block checksum was invalid or the compression is not
+	 *                     supported by this build.
+	 */
+	static void read(std::istream & base, const setup::version & version, std::string & target);
+	
+	/*!
+	 * Check if block streams are stored the same way for two setup data versions.
+	 *
+	 * \return \c true if data decompressed for one version is also valid for the other.
+	 */
+	static bool same_format(const setup::version & a, const setup::version & b);
+	
 };
 
 } // namespace stream
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "util/arena.hpp"
+
+#include <algorithm>
+
+namespace util {
+
+arena_string::arena_string(arena & pool, const char * data, size_t size) : size_(size) {
+	char * copy = pool.allocate(size + 1);
+	std::memcpy(copy, data, size);
+	copy[size] = '\0';
+	data_ = copy;
+}
+
+arena_string::arena_string(arena & pool, const std::string & str) : size_(str.size()) {
+	char * copy = pool.allocate(size_ + 1);
+	std::memcpy(copy, str.c_str(), size_ + 1);
+	data_ = copy;
+}
+
+const size_t arena::block_size;
+
+char * arena::allocate_block(size_t size) {
+	
+	size_t capacity = std::max(size, size_t(block_size));
+	blocks_.push_back(NULL);
+	char * block = blocks_.back() = new char[capacity];
+	
+	// Keep using the current block for small allocations if it has more space left
+	if(capacity - size >= available_) {
+		next_ = block + size, available_ = capacity - size;
+	}
+	
+	return block;
+}
+
+arena_string arena::intern(const std::string & str) {
+	
+	string_set::const_iterator it = interned_.find(arena_string::reference(str.c_str(), str.size()));
+	if(it != interned_.end()) {
+		return *it;
+	}
+	
+	arena_string result(*this, str);
+	interned_.insert(result);
+	return result;
+}
+
+arena & arena::child() {
+	children_.push_back(NULL);
+	return *(children_.back() = new arena);
+}
+
+void arena::clear() {
+	for(std::vector<char *>::const_iterator i = blocks_.begin(); i != blocks_.end(); ++i) {
+		delete[] *i;
+	}
+	blocks_.clear();
+	for(std::vector<arena *>::const_iterator i = children_.begin(); i != children_.end(); ++i) {
+		delete *i;
+	}
+	children_.clear();
+	next_ = NULL, available_ = 0;
+	interned_.clear();
+}
+
+} // namespace util
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Block allocator for strings that share a common lifetime.
+ */
+#ifndef INNOEXTRACT_UTIL_ARENA_HPP
+#define INNOEXTRACT_UTIL_ARENA_HPP
+
+#include <stddef.h>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_set.hpp>
+
+namespace util {
+
+class arena;
+
+/*!
+ * Reference to an immutable, NUL-terminated string stored in an \ref arena.
+ *
+ * Copies are cheap and refer to the same characters, which stay valid as long as the
+ * arena that owns them.
+ */
+class arena_string {
+	
+	const char * data_;
+	size_t size_;
+	
+public:
+	
+	arena_string() : data_(""), size_(0) { }
+	
+	//! Copy a string into an arena.
+	arena_string(arena & pool, const char * data, size_t size);
+	
+	//! Copy a string into an arena.
+	arena_string(arena & pool, const std::string & str);
+	
+	/*!
+	 * Reference a NUL-terminated string that is already stored in an arena.
+	 *
+	 * \param data Pointer to the characters, <code>data[size]</code> must be \c '\0'.
+	 * \param size Length of the string in bytes.
+	 */
+	static arena_string reference(const char * data, size_t size) {
+		arena_string result;
+		result.data_ = data, result.size_ = size;
+		return result;
+	}
+	
+	const char * data() const { return data_; }
+	const char * c_str() const { return data_; }
+	size_t size() const { return size_; }
+	size_t length() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	
+	const char * begin() const { return data_; }
+	const char * end() const { return data_ + size_; }
+	
+	//! \return a copy of the string.
+	std::string str() const { return std::string(data_, size_); }
+	
+	void clear() { data_ = "", size_ = 0; }
+	
+};
+
+inline bool operator==(const arena_string & a, const arena_string & b) {
+	return a.size() == b.size() && (a.data() == b.data()
+	                                || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+inline bool operator==(const arena_string & a, const std::string & b) {
+	return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+inline bool operator==(const std::string & a, const arena_string & b) { return b == a; }
+
+inline bool operator!=(const arena_string & a, const arena_string & b) { return !(a == b); }
+inline bool operator!=(const arena_string & a, const std::string & b) { return !(a == b); }
+inline bool operator!=(const std::string & a, const arena_string & b) { return !(a == b); }
+
+inline std::ostream & operator<<(std::ostream & os, const arena_string & str) {
+	return os.write(str.data(), std::streamsize(str.size()));
+}
+
+struct arena_string_hash {
+	size_t operator()(const arena_string & str) const {
+		return boost::hash_range(str.begin(), str.end());
+	}
+};
+
+/*!
+ * Memory pool that hands out memory from large blocks.
+ *
+ * Individual allocations cannot be freed - all memory is released together when the
+ * arena is cleared or destroyed.
+ *
+ * Strings that are expected to repeat can be stored with \ref intern so that equal
+ * strings share the same characters and can be compared by address.
+ *
+ * An arena must only be used by one thread at a time. Threads that produce strings with
+ * the same lifetime can each allocate from their own \ref child arena.
+ */
+class arena : private boost::noncopyable {
+	
+	std::vector<char *> blocks_;
+	std::vector<arena *> children_;
+	
+	char * next_;      //!< Start of the unused part of the current block.
+	size_t available_; //!< Number of unused bytes in the current block.
+	
+	typedef boost::unordered_set<arena_string, arena_string_hash> string_set;
+	string_set interned_;
+	
+	char * allocate_block(size_t size);
+	
+public:
+	
+	//! Default block size for allocations.
+	static const size_t block_size = 64 * 1024;
+	
+	arena() : next_(NULL), available_(0) { }
+	
+	~arena() { clear(); }
+	
+	//! Allocate uninitialized memory that stays valid until the arena is cleared.
+	char * allocate(size_t size) {
+		if(size > available_) {
+			return allocate_block(size);
+		}
+		char * result = next_;
+		next_ += size, available_ -= size;
+		return result;
+	}
+	
+	/*!
+	 * Store a string or find an equal string that was already interned.
+	 *
+	 * \return a string whose characters are shared by all equal interned strings.
+	 */
+	arena_string intern(const std::string & str);
+	
+	/*!
+	 * Create an arena that is cleared and destroyed together with this one.
+	 *
+	 * Strings interned in the child are not shared with this arena.
+	 */
+	arena & child();
+	
+	//! Release all memory allocated from this arena.
+	void clear();
+	
+};
+
+} // namespace util
+
+#endif // INNOEXTRACT_UTIL_ARENA_HPP
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Bounds-checked reader for data stored in memory.
+ */
+#ifndef INNOEXTRACT_UTIL_CURSOR_HPP
+#define INNOEXTRACT_UTIL_CURSOR_HPP
+
+#include <stddef.h>
+#include <cstring>
+#include <string>
+
+namespace util {
+
+class arena;
+
+/*!
+ * Sequential reader for a block of memory.
+ *
+ * This is used to parse setup headers after they have been decompressed and provides
+ * the same operations as the \c std::istream functions in \ref util/load.hpp.
+ * Reading past the end throws a \c std::ios_base::failure, like a stream with exceptions
+ * enabled would.
+ *
+ * The cursor does not own the data - it must stay valid while the cursor is used.
+ *
+ * Entries that are parsed only to get past them can put the cursor into skip mode,
+ * in which \ref binary_string and \ref encoded_string fields are stepped over using
+ * their length prefix and left empty instead of being copied and converted.
+ *
+ * Fields loaded as \ref encoded_arena_string are stored in the arena attached to the
+ * cursor with \ref set_arena.
+ */
+class cursor {
+	
+	const char * pos_;
+	const char * end_;
+	bool skip_strings_;
+	arena * arena_;
+	
+	//! Throw an error about reading past the end of the data.
+	static void underflow();
+	
+public:
+	
+	cursor(const char * data, size_t size)
+		: pos_(data), end_(data + size), skip_strings_(false), arena_(NULL) { }
+	
+	explicit cursor(const std::string & data)
+		: pos_(data.data()), end_(data.data() + data.size()), skip_strings_(false),
+		  arena_(NULL) { }
+	
+	//! \return the number of bytes that have not been read yet.
+	size_t remaining() const { return size_t(end_ - pos_); }
+	
+	//! \return \c true if all data has been read.
+	bool empty() const { return pos_ == end_; }
+	
+	//! \return a pointer to the next byte to be read.
+	const char * position() const { return pos_; }
+	
+	/*!
+	 * Consume a number of bytes.
+	 *
+	 * \return a pointer to the consumed bytes, which stays valid as long as the data.
+	 */
+	const char * take(size_t size) {
+		if(size > remaining()) {
+			underflow();
+		}
+		const char * data = pos_;
+		pos_ += size;
+		return data;
+	}
+	
+	//! Copy the next bytes into a buffer.
+	void read(char * buffer, size_t size) {
+		std::memcpy(buffer, take(size), size);
+	}
+	
+	//! Skip over a number of bytes.
+	void skip(size_t size) {
+		(void)take(size);
+	}
+	
+	//! Enable or disable skip mode for length-prefixed strings.
+	void skip_strings(bool skip) { skip_strings_ = skip; }
+	
+	//! \return \c true if length-prefixed strings are skipped instead of loaded.
+	bool skips_strings() const { return skip_strings_; }
+	
+	//! Set the arena that receives strings loaded from this cursor.
+	void set_arena(arena * pool) { arena_ = pool; }
+	
+	//! \return the arena that receives strings loaded from this cursor, or \c NULL.
+	arena * get_arena() const { return arena_; }
+	
+};
+
+} // namespace util
+
+#endif // INNOEXTRACT_UTIL_CURSOR_HPP
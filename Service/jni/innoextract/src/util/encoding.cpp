@@ -52,6 +52,7 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <iterator>
 #include <sstream>
@@ -68,7 +69,21 @@
 #include <windows.h>
 #endif
 
+#if INNOEXTRACT_HAVE_STD_THREAD
+#include <atomic>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define INNOEXTRACT_ENCODING_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define INNOEXTRACT_ENCODING_NEON 1
+#endif
+
+#include <boost/cstdint.hpp>
 #include <boost/foreach.hpp>
+#include <boost/noncopyable.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/unordered_map.hpp>
 
@@ -136,7 +151,11 @@ static void to_utf8_fallback(const std::string & from, std::string & to, codepag
 	}
 	
 	if(warn) {
+		#if INNOEXTRACT_HAVE_STD_THREAD
+		static std::atomic<bool> warned(false); // Entries may be decoded on several threads
+		#else
 		static bool warned = false;
+		#endif
 		log_warning << "Unknown data while converting from CP" << cp << " to UTF-8.";
 		if(!warned && (cp == cp_windows1252 || cp == cp_utf16le)) {
 			#if INNOEXTRACT_HAVE_ICONV
@@ -150,6 +169,90 @@ static void to_utf8_fallback(const std::string & from, std::string & to, codepag
 	
 }
 
+//! \return the number of bytes at the start of the data that are ASCII characters
+static size_t ascii_run(const char * data, size_t size) {
+	
+	const char * begin = data;
+	
+	// Check 16 bytes at a time and find the exact position in the scalar loop below
+	
+	#if defined(INNOEXTRACT_ENCODING_SSE2)
+	for(; size >= 16; data += 16, size -= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+		if(_mm_movemask_epi8(v) != 0) {
+			break;
+		}
+	}
+	#elif defined(INNOEXTRACT_ENCODING_NEON)
+	for(; size >= 16; data += 16, size -= 16) {
+		uint64x2_t w = vreinterpretq_u64_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(data)));
+		if(((vgetq_lane_u64(w, 0) | vgetq_lane_u64(w, 1)) & 0x8080808080808080ull) != 0) {
+			break;
+		}
+	}
+	#else
+	for(; size >= 16; data += 16, size -= 16) {
+		boost::uint64_t w[2];
+		std::memcpy(w, data, sizeof(w));
+		if(((w[0] | w[1]) & 0x8080808080808080ull) != 0) {
+			break;
+		}
+	}
+	#endif
+	
+	for(; size != 0 && boost::uint8_t(*data) < 0x80; data++, size--) { }
+	
+	return size_t(data - begin);
+}
+
+/*!
+ * Convert UTF-16LE code units at the start of the data to UTF-8 for as long as they are
+ * ASCII characters.
+ *
+ * \param from  UTF-16LE data.
+ * \param count Number of complete code units in the data.
+ * \param to    Output buffer with room for \c count bytes.
+ *
+ * \return the number of code units converted.
+ */
+static size_t utf16le_narrow_ascii(const char * from, size_t count, char * to) {
+	
+	const char * begin = from;
+	
+	// Convert 16 code units at a time and find the exact position in the scalar loop below
+	
+	#if defined(INNOEXTRACT_ENCODING_SSE2)
+	const __m128i mask = _mm_set1_epi16(short(0xff80));
+	for(; count >= 16; from += 32, to += 16, count -= 16) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from + 16));
+		__m128i high = _mm_and_si128(_mm_or_si128(a, b), mask);
+		if(_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xffff) {
+			break;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(to), _mm_packus_epi16(a, b));
+	}
+	#elif defined(INNOEXTRACT_ENCODING_NEON)
+	for(; count >= 16; from += 32, to += 16, count -= 16) {
+		uint8x16_t a = vld1q_u8(reinterpret_cast<const uint8_t *>(from));
+		uint8x16_t b = vld1q_u8(reinterpret_cast<const uint8_t *>(from + 16));
+		uint64x2_t w = vreinterpretq_u64_u8(vorrq_u8(a, b));
+		if(((vgetq_lane_u64(w, 0) | vgetq_lane_u64(w, 1)) & 0xff80ff80ff80ff80ull) != 0) {
+			break;
+		}
+		uint8x16_t narrow = vcombine_u8(vmovn_u16(vreinterpretq_u16_u8(a)),
+		                                vmovn_u16(vreinterpretq_u16_u8(b)));
+		vst1q_u8(reinterpret_cast<uint8_t *>(to), narrow);
+	}
+	#endif
+	
+	for(; count != 0 && from[1] == 0 && boost::uint8_t(from[0]) < 0x80; from += 2, count--) {
+		*to++ = from[0];
+	}
+	
+	return size_t(from - begin) / 2;
+}
+
 #if INNOEXTRACT_HAVE_BUILTIN_CONV
 
 static size_t utf8_length(unicode_char chr) {
@@ -160,7 +263,8 @@ static size_t utf8_length(unicode_char chr) {
 	return 1;
 }
 
-static void utf8_write(std::string & to, unicode_char chr) {
+//! Write a character to a buffer with room for at least four bytes
+static char * utf8_write(char * to, unicode_char chr) {
 	
 	static const boost::uint8_t first_bytes[7] = {
 		0x00, 0x00, 0xc0, 0xe0, 0xf0, 0xf8, 0xfc
@@ -181,12 +285,13 @@ static void utf8_write(std::string & to, unicode_char chr) {
 	// Add them to the output
 	const boost::uint8_t * cur_byte = bytes;
 	switch(length) {
-		case 4: to.push_back(char(*cur_byte++));
-		case 3: to.push_back(char(*cur_byte++));
-		case 2: to.push_back(char(*cur_byte++));
-		case 1: to.push_back(char(*cur_byte++));
+		case 4: *to++ = char(*cur_byte++);
+		case 3: *to++ = char(*cur_byte++);
+		case 2: *to++ = char(*cur_byte++);
+		case 1: *to++ = char(*cur_byte++);
 	}
 	
+	return to;
 }
 
 //! \return true c is is the first part of an UTF-16 surrogate pair
@@ -205,19 +310,27 @@ static void utf16le_to_utf8(const std::string & from, std::string & to) {
 		log_warning << "Unexpected trailing byte in UTF-16 string.";
 	}
 	
-	to.clear();
-	to.reserve(from.size() / 2); // optimistically, most strings only have ASCII characters
+	// Code units take up to three bytes each, surrogate pairs four bytes for two units
+	to.resize(from.size() / 2 * 3 + 3);
+	char * out = &to[0];
 	
 	bool warn = false;
 	
-	std::string::const_iterator it = from.begin();
-	std::string::const_iterator end = from.end();
+	const char * it = from.data();
+	const char * end = it + from.size();
 	while(it != end) {
 		
+		// Most strings only have ASCII characters - convert those in bulk
+		size_t ascii = utf16le_narrow_ascii(it, size_t(end - it) / 2, out);
+		it += ascii * 2, out += ascii;
+		if(it == end) {
+			break;
+		}
+		
 		unicode_char chr = boost::uint8_t(*it++);
 		if(it == end) {
 			warn = true;
-			utf8_write(to, replacement_char);
+			out = utf8_write(out, replacement_char);
 			break;
 		}
 		chr |= unicode_char(boost::uint8_t(*it++)) << 8;
@@ -226,13 +339,13 @@ static void utf16le_to_utf8(const std::string & from, std::string & to) {
 		if(is_utf16_high_surrogate(chr)) {
 			if(it == end) {
 				warn = true;
-				utf8_write(to, replacement_char);
+				out = utf8_write(out, replacement_char);
 				break;
 			}
 			unicode_char d = boost::uint8_t(*it++);
 			if(it == end) {
 				warn = true;
-				utf8_write(to, replacement_char);
+				out = utf8_write(out, replacement_char);
 				break;
 			}
 			d |= unicode_char(boost::uint8_t(*it++)) << 8;
@@ -240,7 +353,7 @@ static void utf16le_to_utf8(const std::string & from, std::string & to) {
 				chr = ((chr - 0xd800) << 10) + (d - 0xdc00) + 0x0010000;
 			} else {
 				warn = true;
-				utf8_write(to, replacement_char);
+				out = utf8_write(out, replacement_char);
 				continue;
 			}
 		}
@@ -249,13 +362,15 @@ static void utf16le_to_utf8(const std::string & from, std::string & to) {
 		if(chr > 0x0010FFFF) {
 			warn = true;
 			// Invalid character (greater than the maximum unicode value)
-			utf8_write(to, replacement_char);
+			out = utf8_write(out, replacement_char);
 			continue;
 		}
 		
-		utf8_write(to, chr);
+		out = utf8_write(out, chr);
 	}
 	
+	to.resize(size_t(out - &to[0]));
+	
 	if(warn) {
 		log_warning << "Unexpected data while converting from UTF-16LE to UTF-8.";
 	}
@@ -273,23 +388,36 @@ static void windows1252_to_utf8(const std::string & from, std::string & to) {
 
 	BOOST_STATIC_ASSERT(sizeof(replacements) == (160 - 128) * sizeof(*replacements));
 	
-	to.clear();
-	to.reserve(from.size()); // optimistically, most strings only have ASCII characters
+	// All replacements are in the BMP and take up to three bytes
+	to.resize(from.size() * 3);
+	char * out = &to[0];
 	
 	bool warn = false;
 	
-	BOOST_FOREACH(char c, from) {
+	const char * it = from.data();
+	const char * end = it + from.size();
+	while(it != end) {
+		
+		// Most strings only have ASCII characters - copy those in bulk
+		size_t ascii = ascii_run(it, size_t(end - it));
+		std::memcpy(out, it, ascii);
+		it += ascii, out += ascii;
+		if(it == end) {
+			break;
+		}
 		
 		// Windows-1252 maps almost directly to Unicode - yay!
-		unicode_char chr = boost::uint8_t(c);
+		unicode_char chr = boost::uint8_t(*it++);
 		if(chr >= 128 && chr < 160) {
 			chr = replacements[chr - 128];
 			warn = warn || (chr == unicode_char(replacement_char));
 		}
 		
-		utf8_write(to, chr);
+		out = utf8_write(out, chr);
 	}
 	
+	to.resize(size_t(out - &to[0]));
+	
 	if(warn) {
 		log_warning << "Unexpected data while converting from Windows-1252 to UTF-8.";
 	}
@@ -311,8 +439,43 @@ static bool to_utf8_builtin(const std::string & from, std::string & to, codepage
 
 #if INNOEXTRACT_HAVE_ICONV
 
-typedef boost::unordered_map<codepage_id, iconv_t> converter_map;
-static converter_map converters;
+// thread_local is only available in MSVC 2015 and newer
+#if INNOEXTRACT_HAVE_STD_THREAD && (!defined(_MSC_VER) || _MSC_VER >= 1900)
+#define INNOEXTRACT_THREAD_LOCAL_CONVERTERS 1
+#endif
+
+/*!
+ * Open iconv handles and a reusable output buffer.
+ *
+ * iconv handles keep conversion state and can only be used by one thread at a time,
+ * so each thread gets its own set of converters.
+ */
+struct converter_cache : private boost::noncopyable {
+	
+	typedef boost::unordered_map<codepage_id, iconv_t> converter_map;
+	
+	converter_map converters;
+	
+	std::string buffer;
+	
+	~converter_cache() {
+		BOOST_FOREACH(const converter_map::value_type & converter, converters) {
+			if(converter.second != iconv_t(-1)) {
+				iconv_close(converter.second);
+			}
+		}
+	}
+	
+};
+
+static converter_cache & get_converter_cache() {
+	#if INNOEXTRACT_THREAD_LOCAL_CONVERTERS
+	static thread_local converter_cache cache;
+	#else
+	static converter_cache cache;
+	#endif
+	return cache;
+}
 
 //! Get names for encodings where iconv doesn't have the codepage alias
 static const char * get_encoding_name(codepage_id codepage) {
@@ -387,10 +550,12 @@ static const char * get_encoding_name(codepage_id codepage) {
 	}
 }
 
-static iconv_t get_converter(codepage_id codepage) {
+static iconv_t get_converter(converter_cache & cache, codepage_id codepage) {
+	
+	converter_cache::converter_map & converters = cache.converters;
 	
 	// Try to reuse an existing converter if possible
-	converter_map::const_iterator i = converters.find(codepage);
+	converter_cache::converter_map::const_iterator i = converters.find(codepage);
 	if(i != converters.end()) {
 		return i->second;
 	}
@@ -424,11 +589,16 @@ static iconv_t get_converter(codepage_id codepage) {
 
 static bool to_utf8_iconv(const std::string & from, std::string & to, codepage_id cp) {
 	
-	iconv_t converter = get_converter(cp);
+	converter_cache & cache = get_converter_cache();
+	
+	iconv_t converter = get_converter(cache, cp);
 	if(converter == iconv_t(-1)) {
 		return false;
 	}
 	
+	// Convert into the buffer, which keeps its size between calls
+	std::string & buffer = cache.buffer;
+	
 	/*
 	 * Some iconv implementations declare the second parameter of iconv() as
 	 * const char **, others as char **.
@@ -453,10 +623,13 @@ static bool to_utf8_iconv(const std::string & from, std::string & to, codepage_i
 	
 	while(insize) {
 		
-		to.resize(outbase + ceildiv(insize, skip) + 4);
+		size_t needed = outbase + ceildiv(insize, skip) + 4;
+		if(buffer.size() < needed) {
+			buffer.resize(std::max(needed, buffer.size() * 2));
+		}
 		
-		char * outbuf = &to[0] + outbase;
-		size_t outsize = to.size() - outbase;
+		char * outbuf = &buffer[0] + outbase;
+		size_t outsize = buffer.size() - outbase;
 		
 		size_t ret = iconv(converter, inbuf, &insize, &outbuf, &outsize);
 		if(ret == size_t(-1)) {
@@ -465,7 +638,7 @@ static bool to_utf8_iconv(const std::string & from, std::string & to, codepage_i
 			} else if(/*errno == EILSEQ &&*/ insize >= 2) {
 				// invalid byte (sequence) - add a replacement char and try the next byte
 				if(outsize == 0) {
-					to.push_back(replacement_char);
+					buffer.push_back(replacement_char);
 				} else {
 					*outbuf = replacement_char;
 					outsize--;
@@ -480,14 +653,14 @@ static bool to_utf8_iconv(const std::string & from, std::string & to, codepage_i
 			}
 		}
 		
-		outbase = to.size() - outsize;
+		outbase = buffer.size() - outsize;
 	}
 	
 	if(warn) {
 		log_warning << "Unexpected data while converting from CP" << cp << " to UTF-8.";
 	}
 	
-	to.resize(outbase);
+	to.assign(buffer.data(), outbase);
 	
 	return true;
 }
@@ -557,8 +730,43 @@ static bool to_utf8_win32(const std::string & from, std::string & to, codepage_i
 
 #endif // INNOEXTRACT_HAVE_WIN32_CONV
 
+//! Check if the first 128 characters of an encoding match ASCII.
+static bool is_ascii_compatible(codepage_id cp) {
+	return (cp >= 1250 && cp <= 1258) || cp == 874 || cp == 932 || cp == 936 || cp == 949
+	       || cp == 950 || (cp >= cp_iso_8859_1 && cp <= 28605) || cp == cp_ascii
+	       || cp == cp_utf8;
+}
+
 } // anonymous namespace
 
+size_t ascii_size(const char * data, size_t size, codepage_id cp) {
+	
+	if(cp == cp_utf16le) {
+		if(size % 2) {
+			return size_t(-1);
+		}
+		for(size_t i = 0; i < size; i += 2) {
+			if(boost::uint8_t(data[i]) >= 128 || data[i + 1] != 0) {
+				return size_t(-1);
+			}
+		}
+		return size / 2;
+	}
+	
+	if(!is_ascii_compatible(cp) || ascii_run(data, size) != size) {
+		return size_t(-1);
+	}
+	return size;
+}
+
+void ascii_to_utf8(const char * from, size_t size, char * to, codepage_id cp) {
+	if(cp == cp_utf16le) {
+		utf16le_narrow_ascii(from, size / 2, to);
+	} else {
+		std::memcpy(to, from, size);
+	}
+}
+
 void to_utf8(const std::string & from, std::string & to, codepage_id cp) {
 	
 	if(from.empty()) {
@@ -26,6 +26,7 @@
 #ifndef INNOEXTRACT_UTIL_ENCODING_HPP
 #define INNOEXTRACT_UTIL_ENCODING_HPP
 
+#include <stddef.h>
 #include <string>
 
 #include <boost/cstdint.hpp>
@@ -44,6 +45,32 @@ typedef boost::uint32_t codepage_id;
  */
 void to_utf8(const std::string & from, std::string & to, codepage_id codepage = 1252);
 
+/*!
+ * Get the size of a string after conversion to UTF-8 if it only contains ASCII characters.
+ *
+ * Such strings can be converted with \ref ascii_to_utf8, which is much faster than
+ * \ref to_utf8.
+ *
+ * \param data     The input string.
+ * \param size     The size of the input string in bytes.
+ * \param codepage The Windows codepage number for the input string encoding.
+ *
+ * \return the size of the converted string or \c size_t(-1) if the string contains
+ *         other characters or the encoding is not known to be compatible with ASCII.
+ */
+size_t ascii_size(const char * data, size_t size, codepage_id codepage);
+
+/*!
+ * Convert a string that only contains ASCII characters to UTF-8.
+ *
+ * \param from     The input string, which must have passed \ref ascii_size.
+ * \param size     The size of the input string in bytes.
+ * \param to       Output buffer that receives the number of bytes returned by
+ *                 \ref ascii_size.
+ * \param codepage The Windows codepage number for the input string encoding.
+ */
+void ascii_to_utf8(const char * from, size_t size, char * to, codepage_id codepage);
+
 } // namespace util
 
 #endif // INNOEXTRACT_UTIL_ENCODING_HPP
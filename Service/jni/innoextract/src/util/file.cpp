@@ -0,0 +1,884 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "util/file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#include "configure.hpp"
+
+#if INNOEXTRACT_HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#if INNOEXTRACT_HAVE_STD_THREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#if INNOEXTRACT_HAVE_O_DIRECT && INNOEXTRACT_HAVE_POSIX_MEMALIGN
+#include <stdlib.h>
+#define INNOEXTRACT_DIRECT_IO 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define INNOEXTRACT_ZERO_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define INNOEXTRACT_ZERO_NEON 1
+#endif
+
+namespace util {
+
+namespace {
+
+//! Block size to use if the filesystem does not provide one.
+const size_t default_block_size = 4096;
+
+//! Amount of data to write to a mapping before scheduling it for writeback.
+const size_t map_writeback_size = 1024 * 1024;
+
+#if INNOEXTRACT_DIRECT_IO
+
+//! Alignment of memory buffers and file offsets for direct I/O.
+const size_t direct_alignment = 4096;
+
+const size_t direct_buffer_size = 1024 * 1024;
+
+//! Aligned buffers that can be reused for other files.
+class direct_buffer_pool {
+	
+	std::vector<char *> buffers;
+	
+public:
+	
+	char * acquire() {
+		if(!buffers.empty()) {
+			char * buffer = buffers.back();
+			buffers.pop_back();
+			return buffer;
+		}
+		void * buffer;
+		if(posix_memalign(&buffer, direct_alignment, direct_buffer_size) != 0) {
+			return NULL;
+		}
+		return static_cast<char *>(buffer);
+	}
+	
+	void release(char * buffer) {
+		buffers.push_back(buffer);
+	}
+	
+	~direct_buffer_pool() {
+		for(size_t i = 0; i < buffers.size(); i++) {
+			free(buffers[i]);
+		}
+	}
+	
+} direct_buffers;
+
+bool set_direct_flag(int fd, bool enable) {
+	int flags = fcntl(fd, F_GETFL);
+	if(flags == -1) {
+		return false;
+	}
+	flags = enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+	return fcntl(fd, F_SETFL, flags) != -1;
+}
+
+#endif
+
+#if !defined(_WIN32)
+
+bool write_all(int fd, const char * data, size_t size) {
+	while(size) {
+		ssize_t written = ::write(fd, data, size);
+		if(written < 0 && errno == EINTR) {
+			continue;
+		} else if(written <= 0) {
+			return false;
+		}
+		data += written, size -= size_t(written);
+	}
+	return true;
+}
+
+#endif
+
+} // anonymous namespace
+
+bool is_zero(const char * data, size_t size) {
+	
+	// Check 64 bytes at a time and only branch once per iteration
+	
+	#if defined(INNOEXTRACT_ZERO_SSE2)
+	for(; size >= 64; data += 64, size -= 64) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32));
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48));
+		__m128i v = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+		if(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xffff) {
+			return false;
+		}
+	}
+	#elif defined(INNOEXTRACT_ZERO_NEON)
+	for(; size >= 64; data += 64, size -= 64) {
+		const uint8_t * p = reinterpret_cast<const uint8_t *>(data);
+		uint8x16_t v = vorrq_u8(vorrq_u8(vld1q_u8(p), vld1q_u8(p + 16)),
+		                        vorrq_u8(vld1q_u8(p + 32), vld1q_u8(p + 48)));
+		uint64x2_t w = vreinterpretq_u64_u8(v);
+		if((vgetq_lane_u64(w, 0) | vgetq_lane_u64(w, 1)) != 0) {
+			return false;
+		}
+	}
+	#else
+	for(; size >= 64; data += 64, size -= 64) {
+		boost::uint64_t w[8];
+		std::memcpy(w, data, sizeof(w));
+		if((w[0] | w[1] | w[2] | w[3] | w[4] | w[5] | w[6] | w[7]) != 0) {
+			return false;
+		}
+	}
+	#endif
+	
+	for(; size > 0; data++, size--) {
+		if(*data != 0) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool output_file::write(const char * data, size_t size) {
+	
+	if(map_) {
+		return write_mapped(data, size);
+	}
+	
+	if(!sparse_) {
+		return write_data(data, size);
+	}
+	
+	while(size) {
+		
+		// Only whole blocks can become holes - write anything up to the next block boundary
+		size_t misalignment = size_t(offset_ % block_size_);
+		if(misalignment != 0 || size < block_size_) {
+			size_t n = std::min(size, block_size_ - misalignment);
+			if(!write_data(data, n)) {
+				return false;
+			}
+			data += n, size -= n;
+			continue;
+		}
+		
+		// Find a run of blocks that are either all zero or all contain data
+		bool zero = is_zero(data, block_size_);
+		size_t n = block_size_;
+		while(size - n >= block_size_ && is_zero(data + n, block_size_) == zero) {
+			n += block_size_;
+		}
+		
+		if(zero) {
+			hole_ += n, offset_ += n;
+		} else if(!write_data(data, n)) {
+			return false;
+		}
+		data += n, size -= n;
+		
+	}
+	
+	return true;
+}
+
+bool output_file::write_mapped(const char * data, size_t size) {
+	
+	if(size > map_size_ - offset_) {
+		return false;
+	}
+	
+	char * target = map_ + offset_;
+	if(data != target) {
+		std::memcpy(target, data, size);
+	}
+	offset_ += size;
+	
+	if(offset_ - map_flushed_ >= map_writeback_size) {
+		boost::uint64_t end = offset_ - offset_ % map_writeback_size;
+		writeback(map_ + map_flushed_, size_t(end - map_flushed_));
+		map_flushed_ = end;
+	}
+	
+	return true;
+}
+
+#if defined(_WIN32)
+
+output_file::output_file()
+	: handle_(INVALID_HANDLE_VALUE), offset_(0), hole_(0)
+	, block_size_(default_block_size), sparse_(false)
+	, direct_buffer_(NULL), direct_size_(0), map_(NULL), map_size_(0), map_flushed_(0) { }
+
+bool output_file::open(const boost::filesystem::path & path) {
+	
+	close();
+	
+	// Read access is needed to map the file
+	handle_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+	                      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	
+	return is_open();
+}
+
+bool output_file::is_open() const {
+	return handle_ != INVALID_HANDLE_VALUE;
+}
+
+bool output_file::set_sparse(bool sparse) {
+	
+	if(sparse && !sparse_) {
+		// Without the sparse attribute, skipped regions are filled with zeros by the filesystem
+		DWORD ignored;
+		DeviceIoControl(handle_, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &ignored, NULL);
+	}
+	
+	sparse_ = sparse;
+	
+	return sparse_;
+}
+
+bool output_file::enable_direct_io() {
+	// FILE_FLAG_NO_BUFFERING can only be set when opening the file
+	return false;
+}
+
+char * output_file::map(boost::uint64_t size) {
+	
+	if(map_ || offset_ != 0 || size == 0
+	   || size > boost::uint64_t(std::numeric_limits<size_t>::max())) {
+		return map_;
+	}
+	
+	HANDLE mapping = CreateFileMappingW(handle_, NULL, PAGE_READWRITE, DWORD(size >> 32),
+	                                    DWORD(size), NULL);
+	if(!mapping) {
+		return NULL;
+	}
+	
+	// The view keeps the mapping object alive
+	map_ = static_cast<char *>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, SIZE_T(size)));
+	CloseHandle(mapping);
+	if(!map_) {
+		return NULL;
+	}
+	
+	map_size_ = size, map_flushed_ = 0;
+	
+	return map_;
+}
+
+void output_file::writeback(char * data, size_t size) {
+	// Starts writing the pages without waiting for them to reach the disk
+	FlushViewOfFile(data, size);
+}
+
+bool output_file::unmap() {
+	
+	bool success = (UnmapViewOfFile(map_) != 0);
+	map_ = NULL;
+	
+	// Remove space reserved for data that was never written
+	LARGE_INTEGER position;
+	position.QuadPart = LONGLONG(offset_);
+	return SetFilePointerEx(handle_, position, NULL, FILE_BEGIN) && SetEndOfFile(handle_)
+	       && success;
+}
+
+bool output_file::write_data(const char * data, size_t size) {
+	
+	if(hole_ && !seek_hole()) {
+		return false;
+	}
+	
+	while(size) {
+		DWORD n = DWORD(std::min(size, size_t(1) << 30));
+		DWORD written = 0;
+		if(!WriteFile(handle_, data, n, &written, NULL) || written == 0) {
+			return false;
+		}
+		data += written, size -= written, offset_ += written;
+	}
+	
+	return true;
+}
+
+bool output_file::seek_hole() {
+	LARGE_INTEGER distance;
+	distance.QuadPart = LONGLONG(hole_);
+	if(!SetFilePointerEx(handle_, distance, NULL, FILE_CURRENT)) {
+		return false;
+	}
+	hole_ = 0;
+	return true;
+}
+
+bool output_file::flush() {
+	if(map_ && !unmap()) {
+		return false;
+	}
+	return !hole_ || (seek_hole() && SetEndOfFile(handle_));
+}
+
+bool output_file::sync() {
+	return flush() && FlushFileBuffers(handle_);
+}
+
+void output_file::close() {
+	if(is_open()) {
+		flush();
+		CloseHandle(handle_);
+		handle_ = INVALID_HANDLE_VALUE;
+	}
+	offset_ = 0, hole_ = 0, block_size_ = default_block_size, sparse_ = false;
+	map_size_ = 0, map_flushed_ = 0;
+}
+
+file_handle output_file::release() {
+	flush();
+	file_handle handle = handle_;
+	handle_ = INVALID_HANDLE_VALUE;
+	close();
+	return handle;
+}
+
+bool sync_file(file_handle handle) {
+	return FlushFileBuffers(handle) != 0;
+}
+
+void close_file(file_handle handle) {
+	CloseHandle(handle);
+}
+
+bool sync_filesystem(const boost::filesystem::path & path) {
+	// Flushing a whole volume requires administrator privileges
+	(void)path;
+	return false;
+}
+
+#else // !defined(_WIN32)
+
+output_file::output_file()
+	: handle_(-1), offset_(0), hole_(0), block_size_(default_block_size), sparse_(false)
+	, direct_buffer_(NULL), direct_size_(0), map_(NULL), map_size_(0), map_flushed_(0) { }
+
+bool output_file::open(const boost::filesystem::path & path) {
+	
+	close();
+	
+	int flags = O_CREAT | O_TRUNC;
+	#ifdef O_CLOEXEC
+	flags |= O_CLOEXEC;
+	#endif
+	
+	// Read access is needed to map the file, but don't require it
+	do {
+		handle_ = ::open(path.c_str(), flags | O_RDWR, 0666);
+	} while(handle_ < 0 && errno == EINTR);
+	if(handle_ < 0 && errno == EACCES) {
+		do {
+			handle_ = ::open(path.c_str(), flags | O_WRONLY, 0666);
+		} while(handle_ < 0 && errno == EINTR);
+	}
+	
+	return is_open();
+}
+
+bool output_file::is_open() const {
+	return handle_ >= 0;
+}
+
+bool output_file::set_sparse(bool sparse) {
+	
+	if(sparse && !sparse_) {
+		struct stat buf;
+		if(fstat(handle_, &buf) == 0 && buf.st_blksize >= 512) {
+			block_size_ = size_t(buf.st_blksize);
+		}
+	}
+	
+	sparse_ = sparse;
+	
+	return sparse_;
+}
+
+#if INNOEXTRACT_DIRECT_IO
+
+bool output_file::enable_direct_io() {
+	
+	if(direct_buffer_ || offset_ != 0) {
+		return direct_buffer_ != NULL;
+	}
+	
+	if(!set_direct_flag(handle_, true)) {
+		return false; // Not supported by the filesystem
+	}
+	
+	direct_buffer_ = direct_buffers.acquire();
+	if(!direct_buffer_) {
+		set_direct_flag(handle_, false);
+		return false;
+	}
+	direct_size_ = 0;
+	
+	return true;
+}
+
+bool output_file::flush_direct() {
+	
+	if(!direct_buffer_ || !direct_size_) {
+		return true;
+	}
+	
+	// Write as much as possible without the page cache
+	boost::uint64_t start = offset_ - hole_ - direct_size_;
+	size_t aligned = 0;
+	if(start % direct_alignment == 0) {
+		aligned = direct_size_ - direct_size_ % direct_alignment;
+		if(aligned && !write_all(handle_, direct_buffer_, aligned)) {
+			if(errno != EINVAL) {
+				return false;
+			}
+			// Some filesystems accept O_DIRECT but then reject direct writes
+			off_t position = ::lseek(handle_, 0, SEEK_CUR);
+			if(position == off_t(-1) || boost::uint64_t(position) < start) {
+				return false;
+			}
+			aligned = size_t(boost::uint64_t(position) - start);
+		}
+	}
+	
+	// Write the rest normally - this is usually the unaligned tail at the end of the file
+	if(aligned != direct_size_) {
+		set_direct_flag(handle_, false);
+		bool success = write_all(handle_, direct_buffer_ + aligned, direct_size_ - aligned);
+		end_direct();
+		return success;
+	}
+	
+	direct_size_ = 0;
+	
+	return true;
+}
+
+void output_file::end_direct() {
+	if(direct_buffer_) {
+		set_direct_flag(handle_, false);
+		direct_buffers.release(direct_buffer_);
+		direct_buffer_ = NULL;
+		direct_size_ = 0;
+	}
+}
+
+#else
+
+bool output_file::enable_direct_io() {
+	return false;
+}
+
+bool output_file::flush_direct() {
+	return true;
+}
+
+void output_file::end_direct() { }
+
+#endif
+
+#if INNOEXTRACT_HAVE_MMAP && INNOEXTRACT_HAVE_POSIX_FALLOCATE
+
+char * output_file::map(boost::uint64_t size) {
+	
+	if(map_ || offset_ != 0 || direct_buffer_ || size == 0
+	   || size > boost::uint64_t(std::numeric_limits<size_t>::max())
+	   || size > boost::uint64_t(std::numeric_limits<off_t>::max())) {
+		return map_;
+	}
+	
+	/*
+	 * Allocate the blocks up front: writing to a page of a sparse mapping that cannot be
+	 * backed when the disk is full raises SIGBUS instead of returning an error.
+	 */
+	int ret;
+	do {
+		ret = ::posix_fallocate(handle_, 0, off_t(size));
+	} while(ret == EINTR);
+	if(ret != 0) {
+		::ftruncate(handle_, 0);
+		return NULL;
+	}
+	
+	void * mapping = ::mmap(NULL, size_t(size), PROT_READ | PROT_WRITE, MAP_SHARED, handle_, 0);
+	if(mapping == MAP_FAILED) {
+		::ftruncate(handle_, 0);
+		return NULL;
+	}
+	
+	map_ = static_cast<char *>(mapping);
+	map_size_ = size, map_flushed_ = 0;
+	
+	return map_;
+}
+
+void output_file::writeback(char * data, size_t size) {
+	// Starts writing the pages without waiting for them to reach the disk
+	::msync(data, size, MS_ASYNC);
+}
+
+bool output_file::unmap() {
+	
+	bool success = (::munmap(map_, size_t(map_size_)) == 0);
+	map_ = NULL;
+	
+	// Remove space reserved for data that was never written
+	if(offset_ != map_size_) {
+		int ret;
+		do {
+			ret = ::ftruncate(handle_, off_t(offset_));
+		} while(ret != 0 && errno == EINTR);
+		success = success && ret == 0;
+	}
+	
+	return ::lseek(handle_, off_t(offset_), SEEK_SET) != off_t(-1) && success;
+}
+
+#else
+
+char * output_file::map(boost::uint64_t size) {
+	(void)size;
+	return NULL;
+}
+
+void output_file::writeback(char * data, size_t size) {
+	(void)data, (void)size;
+}
+
+bool output_file::unmap() {
+	return true;
+}
+
+#endif
+
+bool output_file::write_data(const char * data, size_t size) {
+	
+	if(hole_ && !seek_hole()) {
+		return false;
+	}
+	
+	#if INNOEXTRACT_DIRECT_IO
+	// Flushing the buffer can end direct I/O, write any remaining data normally then
+	while(size && direct_buffer_) {
+		size_t n = std::min(size, direct_buffer_size - direct_size_);
+		std::memcpy(direct_buffer_ + direct_size_, data, n);
+		direct_size_ += n, offset_ += n, data += n, size -= n;
+		if(direct_size_ == direct_buffer_size && !flush_direct()) {
+			return false;
+		}
+	}
+	if(!size) {
+		return true;
+	}
+	#endif
+	
+	if(!write_all(handle_, data, size)) {
+		return false;
+	}
+	offset_ += size;
+	
+	return true;
+}
+
+bool output_file::seek_hole() {
+	if(!flush_direct()) {
+		return false;
+	}
+	if(::lseek(handle_, off_t(hole_), SEEK_CUR) == off_t(-1)) {
+		return false;
+	}
+	hole_ = 0;
+	return true;
+}
+
+bool output_file::flush() {
+	if(map_ && !unmap()) {
+		return false;
+	}
+	if(!flush_direct()) {
+		return false;
+	}
+	if(!hole_) {
+		return true;
+	}
+	int ret;
+	do {
+		ret = ::ftruncate(handle_, off_t(offset_));
+	} while(ret != 0 && errno == EINTR);
+	return ret == 0 && seek_hole();
+}
+
+bool output_file::sync() {
+	return flush() && sync_file(handle_);
+}
+
+void output_file::close() {
+	if(is_open()) {
+		flush();
+		end_direct();
+		::close(handle_);
+		handle_ = -1;
+	}
+	offset_ = 0, hole_ = 0, block_size_ = default_block_size, sparse_ = false;
+	map_size_ = 0, map_flushed_ = 0;
+}
+
+file_handle output_file::release() {
+	flush();
+	end_direct();
+	file_handle handle = handle_;
+	handle_ = -1;
+	close();
+	return handle;
+}
+
+bool sync_file(file_handle handle) {
+	int ret;
+	do {
+		#if INNOEXTRACT_HAVE_FDATASYNC
+		ret = ::fdatasync(handle);
+		#else
+		ret = ::fsync(handle);
+		#endif
+	} while(ret != 0 && errno == EINTR);
+	return ret == 0;
+}
+
+void close_file(file_handle handle) {
+	::close(handle);
+}
+
+bool sync_filesystem(const boost::filesystem::path & path) {
+	
+	#if INNOEXTRACT_HAVE_SYNCFS
+	int flags = O_RDONLY;
+	#ifdef O_CLOEXEC
+	flags |= O_CLOEXEC;
+	#endif
+	int fd = ::open(path.c_str(), flags);
+	if(fd >= 0) {
+		int ret = ::syncfs(fd);
+		::close(fd);
+		if(ret == 0) {
+			return true;
+		}
+	}
+	#else
+	(void)path;
+	#endif
+	
+	// Unlike syncfs(), sync() may return before the data has been written on some systems
+	::sync();
+	
+	return false;
+}
+
+#endif // !defined(_WIN32)
+
+output_file::~output_file() {
+	close();
+}
+
+namespace {
+
+//! Maximum number of handles waiting to be synchronized before \ref background_syncer::add blocks.
+const size_t max_pending_syncs = 256;
+
+} // anonymous namespace
+
+#if INNOEXTRACT_HAVE_STD_THREAD
+
+struct background_syncer::state {
+	
+	std::mutex mutex;
+	std::condition_variable changed;
+	
+	std::vector<file_handle> pending; //!< Files added since the last commit
+	std::vector<file_handle> queue;   //!< Committed files not yet picked up by the worker
+	size_t active;                    //!< Number of files being synchronized by the worker
+	bool done;
+	bool failed;
+	
+	std::thread worker;
+	
+	state() : active(0), done(false), failed(false) { }
+	
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		for(;;) {
+			while(queue.empty() && !done) {
+				changed.wait(lock);
+			}
+			if(queue.empty()) {
+				break;
+			}
+			std::vector<file_handle> batch;
+			batch.swap(queue);
+			active = batch.size();
+			lock.unlock();
+			bool success = true;
+			for(size_t i = 0; i < batch.size(); i++) {
+				success = sync_file(batch[i]) && success;
+				close_file(batch[i]);
+			}
+			lock.lock();
+			active = 0;
+			failed = failed || !success;
+			changed.notify_all();
+		}
+	}
+	
+	void commit() {
+		if(pending.empty()) {
+			return;
+		}
+		if(!worker.joinable()) {
+			worker = std::thread(&state::run, this);
+		}
+		queue.insert(queue.end(), pending.begin(), pending.end());
+		pending.clear();
+		changed.notify_all();
+	}
+	
+};
+
+background_syncer::background_syncer() : state_(new state) { }
+
+background_syncer::~background_syncer() {
+	{
+		std::lock_guard<std::mutex> lock(state_->mutex);
+		for(size_t i = 0; i < state_->pending.size(); i++) {
+			close_file(state_->pending[i]);
+		}
+		state_->pending.clear();
+		state_->done = true;
+		state_->changed.notify_all();
+	}
+	if(state_->worker.joinable()) {
+		state_->worker.join();
+	}
+	delete state_;
+}
+
+void background_syncer::add(file_handle handle) {
+	std::unique_lock<std::mutex> lock(state_->mutex);
+	state_->pending.push_back(handle);
+	if(state_->pending.size() >= max_pending_syncs) {
+		state_->commit();
+	}
+	while(state_->queue.size() + state_->active >= max_pending_syncs) {
+		state_->changed.wait(lock);
+	}
+}
+
+void background_syncer::commit() {
+	std::lock_guard<std::mutex> lock(state_->mutex);
+	state_->commit();
+}
+
+bool background_syncer::finish() {
+	std::unique_lock<std::mutex> lock(state_->mutex);
+	state_->commit();
+	while(!state_->queue.empty() || state_->active) {
+		state_->changed.wait(lock);
+	}
+	bool success = !state_->failed;
+	state_->failed = false;
+	return success;
+}
+
+#else // !INNOEXTRACT_HAVE_STD_THREAD
+
+struct background_syncer::state {
+	
+	std::vector<file_handle> pending;
+	bool failed;
+	
+	state() : failed(false) { }
+	
+};
+
+background_syncer::background_syncer() : state_(new state) { }
+
+background_syncer::~background_syncer() {
+	for(size_t i = 0; i < state_->pending.size(); i++) {
+		close_file(state_->pending[i]);
+	}
+	delete state_;
+}
+
+void background_syncer::add(file_handle handle) {
+	state_->pending.push_back(handle);
+	if(state_->pending.size() >= max_pending_syncs) {
+		commit();
+	}
+}
+
+void background_syncer::commit() {
+	for(size_t i = 0; i < state_->pending.size(); i++) {
+		state_->failed = !sync_file(state_->pending[i]) || state_->failed;
+		close_file(state_->pending[i]);
+	}
+	state_->pending.clear();
+}
+
+bool background_syncer::finish() {
+	commit();
+	bool success = !state_->failed;
+	state_->failed = false;
+	return success;
+}
+
+#endif // !INNOEXTRACT_HAVE_STD_THREAD
+
+} // namespace util
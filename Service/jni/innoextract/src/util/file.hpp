@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Unbuffered output file with access to the native file handle, and helpers to make
+ * written data durable.
+ */
+#ifndef INNOEXTRACT_UTIL_FILE_HPP
+#define INNOEXTRACT_UTIL_FILE_HPP
+
+#include <stddef.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace util {
+
+//! Native handle for an open file.
+#if defined(_WIN32)
+typedef void * file_handle;
+#else
+typedef int file_handle;
+#endif
+
+/*!
+ * Check if a memory region contains only zero bytes.
+ */
+bool is_zero(const char * data, size_t size);
+
+/*!
+ * Output file that passes writes directly to the operating system.
+ *
+ * Unlike \ref util::ofstream this does not buffer any data, which makes it possible to
+ * operate on the native handle (for example to set file times) while the file is open.
+ * Callers are expected to write data in reasonably large blocks.
+ */
+class output_file : private boost::noncopyable {
+	
+	file_handle handle_;
+	
+	boost::uint64_t offset_; //!< Logical write position, including skipped blocks.
+	boost::uint64_t hole_;   //!< Number of skipped bytes not yet seeked over.
+	size_t block_size_;
+	bool sparse_;
+	
+	char * direct_buffer_; //!< Aligned buffer for writes that bypass the page cache.
+	size_t direct_size_;   //!< Number of bytes in the direct buffer.
+	
+	char * map_;                //!< Writable mapping of the file contents.
+	boost::uint64_t map_size_;  //!< Size of the mapped region.
+	boost::uint64_t map_flushed_; //!< End of the range already scheduled for writeback.
+	
+	bool write_data(const char * data, size_t size);
+	bool seek_hole();
+	
+	bool flush_direct();
+	void end_direct();
+	
+	bool write_mapped(const char * data, size_t size);
+	void writeback(char * data, size_t size);
+	bool unmap();
+	
+public:
+	
+	output_file();
+	~output_file();
+	
+	/*!
+	 * Create or truncate a file and open it for writing.
+	 *
+	 * \return \c true if the file was opened.
+	 */
+	bool open(const boost::filesystem::path & path);
+	
+	bool is_open() const;
+	
+	/*!
+	 * Enable or disable sparse output for the open file.
+	 *
+	 * In sparse mode, blocks that are aligned to the filesystem block size and contain
+	 * only zero bytes are skipped instead of written, leaving holes in the file.
+	 *
+	 * \return \c true if sparse mode is enabled.
+	 */
+	bool set_sparse(bool sparse);
+	
+	/*!
+	 * Bypass the page cache for the open file.
+	 *
+	 * Data is collected in an aligned buffer and written in large aligned blocks.
+	 * The unaligned tail at the end of the file is written through the page cache.
+	 * This must be called before the first write.
+	 *
+	 * \return \c true if direct I/O is supported for this file.
+	 */
+	bool enable_direct_io();
+	
+	/*!
+	 * Allocate space for the open file and map it into memory.
+	 *
+	 * Data can then be decoded directly into the mapping and passed to \ref write at the
+	 * address it was stored at, which skips copying it. Dirty pages are scheduled for
+	 * writeback as the write position advances.
+	 * \ref flush removes the mapping and truncates the file to the amount of data written.
+	 * This must be called before the first write.
+	 *
+	 * \return the start of the mapping or \c NULL if the file could not be mapped or the
+	 *         space could not be allocated.
+	 */
+	char * map(boost::uint64_t size);
+	
+	//! \return the filesystem block size for the open file.
+	size_t block_size() const { return block_size_; }
+	
+	/*!
+	 * Write a block of data at the current position.
+	 *
+	 * \return \c true if all the data was written.
+	 */
+	bool write(const char * data, size_t size);
+	
+	/*!
+	 * Write any buffered data and extend the file to include zero blocks skipped at the end.
+	 *
+	 * This must be called after the last write before using the native handle.
+	 *
+	 * \return \c true if the file has the correct size.
+	 */
+	bool flush();
+	
+	/*!
+	 * Write the file data to the storage device.
+	 *
+	 * \return \c true if the data was synchronized.
+	 */
+	bool sync();
+	
+	//! Close the file. Does nothing if the file is not open.
+	void close();
+	
+	/*!
+	 * Flush the file and give up ownership of the native handle without closing it.
+	 *
+	 * The caller becomes responsible for closing the handle with \ref close_file.
+	 */
+	file_handle release();
+	
+	//! \return the native handle for the open file.
+	file_handle handle() const { return handle_; }
+	
+};
+
+/*!
+ * Write the data of an open file to the storage device.
+ *
+ * File metadata is only synchronized if it is needed to read back the data.
+ *
+ * \return \c true if the data was synchronized.
+ */
+bool sync_file(file_handle handle);
+
+//! Close a native file handle.
+void close_file(file_handle handle);
+
+/*!
+ * Write all cached data for the filesystem containing a path to the storage device.
+ *
+ * If this is not supported for individual filesystems, this falls back to flushing every
+ * filesystem on the system, which is slow and may return before the data is written.
+ *
+ * \return \c true if the filesystem was synchronized, \c false if it could not be or if
+ *         only the fallback was used.
+ */
+bool sync_filesystem(const boost::filesystem::path & path);
+
+/*!
+ * Synchronize batches of files from a background thread.
+ *
+ * Handles are collected with \ref add and handed to the background thread by \ref commit.
+ * Each handle is closed once its data has been synchronized.
+ * If threads are not available, files are synchronized by \ref commit instead.
+ */
+class background_syncer : private boost::noncopyable {
+	
+	struct state;
+	state * state_;
+	
+public:
+	
+	background_syncer();
+	
+	//! Wait for all committed files and close any handles that were not committed.
+	~background_syncer();
+	
+	/*!
+	 * Queue a file to synchronize with the next batch.
+	 *
+	 * Takes ownership of the handle. Blocks if too many files are waiting to be synchronized.
+	 */
+	void add(file_handle handle);
+	
+	//! Start synchronizing all files added since the last commit.
+	void commit();
+	
+	/*!
+	 * Commit pending files and wait until all files have been synchronized.
+	 *
+	 * \return \c false if any file could not be synchronized.
+	 */
+	bool finish();
+	
+};
+
+} // namespace util
+
+#endif // INNOEXTRACT_UTIL_FILE_HPP
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "util/lazy_string.hpp"
+
+#include <cstring>
+
+namespace util {
+
+lazy_string::lazy_string(arena & pool, const char * data, size_t size, codepage_id codepage)
+	: data_(""), size_(size), codepage_(0), pool_(&pool) {
+	
+	if(size == 0) {
+		return;
+	}
+	
+	size_t ascii = ascii_size(data, size, codepage);
+	if(ascii != size_t(-1)) {
+		char * text = pool.allocate(ascii + 1);
+		ascii_to_utf8(data, size, text, codepage);
+		text[ascii] = '\0';
+		data_ = text, size_ = ascii;
+	} else {
+		char * copy = pool.allocate(size);
+		std::memcpy(copy, data, size);
+		data_ = copy, codepage_ = codepage;
+	}
+	
+}
+
+void lazy_string::convert() const {
+	
+	std::string converted;
+	to_utf8(std::string(data_, size_), converted, codepage_);
+	
+	arena_string result(*pool_, converted);
+	data_ = result.data(), size_ = result.size(), codepage_ = 0;
+}
+
+} // namespace util
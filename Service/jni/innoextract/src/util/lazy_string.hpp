@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Strings that are converted to UTF-8 when they are first used.
+ */
+#ifndef INNOEXTRACT_UTIL_LAZY_STRING_HPP
+#define INNOEXTRACT_UTIL_LAZY_STRING_HPP
+
+#include <stddef.h>
+#include <ostream>
+#include <string>
+
+#include "util/arena.hpp"
+#include "util/encoding.hpp"
+
+namespace util {
+
+/*!
+ * String stored in an \ref arena in its original encoding and converted to UTF-8 on
+ * first access.
+ *
+ * This is used for header fields that are rarely looked at, so that loading the headers
+ * does not need to convert them. Strings that only contain ASCII characters are stored
+ * as UTF-8 right away as that is as cheap as copying them.
+ *
+ * \note Accessing the string is not thread-safe until it has been converted.
+ */
+class lazy_string {
+	
+	mutable const char * data_;
+	mutable size_t size_;
+	mutable codepage_id codepage_; //!< Encoding of the stored data or \c 0 for UTF-8.
+	arena * pool_;
+	
+	void convert() const;
+	
+public:
+	
+	lazy_string() : data_(""), size_(0), codepage_(0), pool_(NULL) { }
+	
+	//! Reference a string that is already UTF-8.
+	explicit lazy_string(const arena_string & str)
+		: data_(str.data()), size_(str.size()), codepage_(0), pool_(NULL) { }
+	
+	/*!
+	 * Store a string in an arena.
+	 *
+	 * \param pool     The arena to store the string and its converted form in.
+	 * \param data     The string data in its original encoding.
+	 * \param size     The size of the string data in bytes.
+	 * \param codepage The Windows codepage number for the string encoding.
+	 */
+	lazy_string(arena & pool, const char * data, size_t size, codepage_id codepage);
+	
+	bool empty() const { return size_ == 0; }
+	
+	//! \return the string converted to UTF-8.
+	arena_string get() const {
+		if(codepage_) {
+			convert();
+		}
+		return arena_string::reference(data_, size_);
+	}
+	
+	//! \return a copy of the string converted to UTF-8.
+	std::string str() const { return get().str(); }
+	
+	void clear() { data_ = "", size_ = 0, codepage_ = 0; }
+	
+};
+
+inline std::ostream & operator<<(std::ostream & os, const lazy_string & str) {
+	return os << str.get();
+}
+
+} // namespace util
+
+#endif // INNOEXTRACT_UTIL_LAZY_STRING_HPP
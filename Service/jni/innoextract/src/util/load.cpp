@@ -44,6 +44,16 @@ void binary_string::load(std::istream & is, std::string & target) {
 	}
 }
 
+void binary_string::load(cursor & is, std::string & target) {
+	boost::uint32_t length = util::load<boost::uint32_t>(is);
+	if(is.skips_strings()) {
+		is.skip(length);
+		target.clear();
+	} else {
+		target.assign(is.take(length), length);
+	}
+}
+
 void binary_string::skip(std::istream&  is) {
 	
 	boost::uint32_t length = util::load<boost::uint32_t>(is);
@@ -54,10 +64,67 @@ void binary_string::skip(std::istream&  is) {
 	discard(is, length);
 }
 
+void binary_string::skip(cursor & is) {
+	is.skip(util::load<boost::uint32_t>(is));
+}
+
 void encoded_string::load(std::istream & is, std::string & target, codepage_id codepage) {
 	to_utf8(binary_string::load(is), target, codepage);
 }
 
+void encoded_string::load(cursor & is, std::string & target, codepage_id codepage) {
+	if(is.skips_strings()) {
+		binary_string::skip(is);
+		target.clear();
+	} else {
+		to_utf8(binary_string::load(is), target, codepage);
+	}
+}
+
+void encoded_arena_string::load(cursor & is, arena_string & target, codepage_id codepage,
+                                bool intern) {
+	
+	boost::uint32_t length = util::load<boost::uint32_t>(is);
+	const char * data = is.take(length);
+	if(is.skips_strings() || length == 0) {
+		target.clear();
+		return;
+	}
+	
+	arena & pool = *is.get_arena();
+	
+	size_t size = ascii_size(data, length, codepage);
+	if(intern) {
+		std::string text;
+		if(size != size_t(-1)) {
+			text.resize(size);
+			ascii_to_utf8(data, length, &text[0], codepage);
+		} else {
+			to_utf8(std::string(data, length), text, codepage);
+		}
+		target = pool.intern(text);
+	} else if(size != size_t(-1)) {
+		char * text = pool.allocate(size + 1);
+		ascii_to_utf8(data, length, text, codepage);
+		text[size] = '\0';
+		target = arena_string::reference(text, size);
+	} else {
+		std::string converted;
+		to_utf8(std::string(data, length), converted, codepage);
+		target = arena_string(pool, converted);
+	}
+}
+
+void encoded_lazy_string::load(cursor & is, lazy_string & target, codepage_id codepage) {
+	boost::uint32_t length = util::load<boost::uint32_t>(is);
+	const char * data = is.take(length);
+	if(is.skips_strings() || length == 0) {
+		target.clear();
+	} else {
+		target = lazy_string(*is.get_arena(), data, length, codepage);
+	}
+}
+
 unsigned to_unsigned(const char * chars, size_t count) {
 #if BOOST_VERSION < 105200
 	return boost::lexical_cast<unsigned>(std::string(chars, count));
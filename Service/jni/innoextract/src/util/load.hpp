@@ -33,7 +33,10 @@
 #include <boost/cstdint.hpp>
 #include <boost/range/size.hpp>
 
+#include "util/arena.hpp"
+#include "util/cursor.hpp"
 #include "util/encoding.hpp"
+#include "util/lazy_string.hpp"
 #include "util/endian.hpp"
 #include "util/types.hpp"
 
@@ -58,11 +61,14 @@ struct binary_string {
 	
 	//! Load a length-prefixed string
 	static void load(std::istream & is, std::string & target);
+	static void load(cursor & is, std::string & target);
 	
 	static void skip(std::istream & is);
+	static void skip(cursor & is);
 	
 	//! Load a length-prefixed string
-	static std::string load(std::istream & is) {
+	template <class Input>
+	static std::string load(Input & is) {
 		std::string target;
 		load(is, target);
 		return target;
@@ -73,6 +79,10 @@ inline std::istream & operator>>(std::istream & is, const binary_string & str) {
 	binary_string::load(is, str.data);
 	return is;
 }
+inline cursor & operator>>(cursor & is, const binary_string & str) {
+	binary_string::load(is, str.data);
+	return is;
+}
 
 /*!
  * Wrapper to load a length-prefixed string with a specified encoding from an input stream
@@ -103,13 +113,15 @@ struct encoded_string {
 	 * \note This function is not thread-safe.
 	 */
 	static void load(std::istream & is, std::string & target, codepage_id codepage);
+	static void load(cursor & is, std::string & target, codepage_id codepage);
 	
 	/*!
 	 * Load and convert a length-prefixed string
 	 *
 	 * \note This function is not thread-safe.
 	 */
-	static std::string load(std::istream & is, codepage_id codepage) {
+	template <class Input>
+	static std::string load(Input & is, codepage_id codepage) {
 		std::string target;
 		load(is, target, codepage);
 		return target;
@@ -120,6 +132,75 @@ inline std::istream & operator>>(std::istream & is, const encoded_string & str)
 	encoded_string::load(is, str.data, str.codepage);
 	return is;
 }
+inline cursor & operator>>(cursor & is, const encoded_string & str) {
+	encoded_string::load(is, str.data, str.codepage);
+	return is;
+}
+
+/*!
+ * Wrapper to load a length-prefixed string with a specified encoding from a \ref cursor
+ * into an \ref arena_string.
+ *
+ * The converted UTF-8 string is stored in the arena attached to the cursor.
+ *
+ * Usage: <code>is >> encoded_arena_string(str, codepage)</code>
+ */
+struct encoded_arena_string {
+	
+	arena_string & data;
+	codepage_id codepage;
+	bool interned;
+	
+	/*!
+	 * \param target   The arena_string object to receive the loaded UTF-8 string.
+	 * \param codepage The Windows codepage for the encoding of the stored string.
+	 * \param intern   Share the characters with equal strings, see \ref arena::intern.
+	 */
+	encoded_arena_string(arena_string & target, codepage_id codepage, bool intern = false)
+		: data(target), codepage(codepage), interned(intern) { }
+	
+	/*!
+	 * Load and convert a length-prefixed string
+	 *
+	 * \note This function is not thread-safe.
+	 */
+	static void load(cursor & is, arena_string & target, codepage_id codepage,
+	                 bool intern = false);
+	
+};
+inline cursor & operator>>(cursor & is, const encoded_arena_string & str) {
+	encoded_arena_string::load(is, str.data, str.codepage, str.interned);
+	return is;
+}
+
+/*!
+ * Wrapper to load a length-prefixed string with a specified encoding from a \ref cursor
+ * into a \ref lazy_string that is only converted to UTF-8 when it is used.
+ *
+ * The string is stored in the arena attached to the cursor.
+ *
+ * Usage: <code>is >> encoded_lazy_string(str, codepage)</code>
+ */
+struct encoded_lazy_string {
+	
+	lazy_string & data;
+	codepage_id codepage;
+	
+	/*!
+	 * \param target   The lazy_string object to receive the loaded string.
+	 * \param codepage The Windows codepage for the encoding of the stored string.
+	 */
+	encoded_lazy_string(lazy_string & target, codepage_id codepage)
+		: data(target), codepage(codepage) { }
+	
+	//! Load a length-prefixed string
+	static void load(cursor & is, lazy_string & target, codepage_id codepage);
+	
+};
+inline cursor & operator>>(cursor & is, const encoded_lazy_string & str) {
+	encoded_lazy_string::load(is, str.data, str.codepage);
+	return is;
+}
 
 /*!
  * Convenience specialization of \ref encoded_string for loading Windows-1252 strings
@@ -139,22 +220,34 @@ T load(std::istream & is) {
 	is.read(buffer, std::streamsize(sizeof(buffer)));
 	return Endianness::template load<T>(buffer);
 }
+//! Load a value of type T that is stored with a specific endianness.
+template <class T, class Endianness>
+T load(cursor & is) {
+	return Endianness::template load<T>(is.take(sizeof(T)));
+}
 //! Load a value of type T that is stored as little endian.
 template <class T>
 T load(std::istream & is) { return load<T, little_endian>(is); }
+//! Load a value of type T that is stored as little endian.
+template <class T>
+T load(cursor & is) { return load<T, little_endian>(is); }
 
 //! Load a bool value
 inline bool load_bool(std::istream & is) {
 	return !!load<boost::uint8_t>(is);
 }
+//! Load a bool value
+inline bool load_bool(cursor & is) {
+	return !!load<boost::uint8_t>(is);
+}
 
 /*!
  * Load a value of type T that is stored with a specific endianness.
- * \param is   Input stream to load from.
+ * \param is   Input stream or \ref cursor to load from.
  * \param bits The number of bits used to store the number.
  */
-template <class T, class Endianness>
-T load(std::istream & is, size_t bits) {
+template <class T, class Endianness, class Input>
+T load(Input & is, size_t bits) {
 	if(bits == 8) {
 		return load<typename compatible_integer<T, 8>::type, Endianness>(is);
 	} else if(bits == 16) {
@@ -167,11 +260,11 @@ T load(std::istream & is, size_t bits) {
 }
 /*!
  * Load a value of type T that is stored as little endian.
- * \param is   Input stream to load from.
+ * \param is   Input stream or \ref cursor to load from.
  * \param bits The number of bits used to store the number.
  */
-template <class T>
-T load(std::istream & is, size_t bits) { return load<T, little_endian>(is, bits); }
+template <class T, class Input>
+T load(Input & is, size_t bits) { return load<T, little_endian>(is, bits); }
 
 /*!
  * Discard a number of bytes from a non-seekable input stream or stream-like object
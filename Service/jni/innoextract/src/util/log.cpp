@@ -22,6 +22,12 @@
 
 #include <iostream>
 
+#include "configure.hpp"
+
+#if INNOEXTRACT_HAVE_STD_THREAD
+#include <mutex>
+#endif
+
 #include "util/console.hpp"
 
 bool logger::debug = false;
@@ -30,8 +36,36 @@ bool logger::quiet = false;
 size_t logger::total_errors = 0;
 size_t logger::total_warnings = 0;
 
+#if INNOEXTRACT_HAVE_STD_THREAD
+//! Keeps messages logged from different threads from being interleaved.
+static std::mutex output_mutex;
+#endif
+
+// thread_local is only available in MSVC 2015 and newer
+#if INNOEXTRACT_HAVE_STD_THREAD && (!defined(_MSC_VER) || _MSC_VER >= 1900)
+static thread_local size_t muted = 0; //!< Number of \ref logger::mute instances.
+#else
+static size_t muted = 0; //!< Number of \ref logger::mute instances.
+#endif
+
+logger::mute::mute() {
+	muted++;
+}
+
+logger::mute::~mute() {
+	muted--;
+}
+
 logger::~logger() {
 	
+	if(muted) {
+		return;
+	}
+	
+	#if INNOEXTRACT_HAVE_STD_THREAD
+	std::lock_guard<std::mutex> lock(output_mutex);
+	#endif
+	
 	color::shell_command previous = color::current;
 	progress::clear();
 	
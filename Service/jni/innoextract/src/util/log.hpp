@@ -29,6 +29,8 @@
 #include <sstream>
 #include <string>
 
+#include <boost/noncopyable.hpp>
+
 #ifdef DEBUG
 #define debug(...) \
 	if(::logger::debug) \
@@ -87,6 +89,20 @@ public:
 	
 	~logger();
 	
+	/*!
+	 * Discard all messages logged by the current thread while an instance exists.
+	 *
+	 * Discarded warnings and errors are not counted.
+	 */
+	class mute : private boost::noncopyable {
+		
+	public:
+		
+		mute();
+		~mute();
+		
+	};
+	
 };
 
 #endif // INNOEXTRACT_UTIL_LOG_HPP
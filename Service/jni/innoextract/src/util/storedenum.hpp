@@ -74,7 +74,7 @@ public:
 	
 	static const size_t size = Mapping::count;
 	
-	explicit stored_enum(std::istream & is) {
+	explicit stored_enum(util::cursor & is) {
 		BOOST_STATIC_ASSERT(size <= (1 << 8));
 		value = util::load<boost::uint8_t>(is);
 	}
@@ -110,7 +110,7 @@ public:
 	
 	static const size_t size = Bits;
 	
-	explicit stored_bitfield(std::istream & is) {
+	explicit stored_bitfield(util::cursor & is) {
 		for(size_t i = 0; i < count; i++) {
 			bits[i] = util::load<base_type>(is);
 		}
@@ -162,7 +162,7 @@ public:
 	typedef typename Mapping::enum_type enum_type;
 	typedef flags<enum_type> flag_type;
 	
-	explicit stored_flags(std::istream & is)
+	explicit stored_flags(util::cursor & is)
 		: stored_bitfield<Mapping::count, PadBits>(is) { }
 	
 	flag_type get() {
@@ -191,6 +191,10 @@ public:
  * Load a flag set where the possible flags are not known at compile-time.
  * Inno Setup stores flag sets as packed bitfields: 1 byte for every 8 flags
  * The only exception is that 3-byte bitfields are padded to 4 bytes for non-16-bit builds.
+ *
+ * The possible flags are collected in a table by \ref add and the bitfield is read and
+ * decoded all at once when the reader is converted to the flag set, or whenever the
+ * table is full.
  */
 template <class Enum>
 class stored_flag_reader {
@@ -204,43 +208,67 @@ private:
 	
 	const size_t pad_bits;
 	
-	std::istream & is;
+	util::cursor & is;
 	
-	typedef boost::uint8_t stored_type;
-	static const size_t stored_bits = sizeof(stored_type) * 8;
+	static const size_t stored_bits = 8;
+	static const size_t max_flags = 128;
 	
-	size_t pos;
-	stored_type buffer;
+	enum_type table[max_flags]; //!< Declared flags that have not been decoded yet.
+	size_t count;
+	size_t bytes; //!< Number of bitfield bytes read so far.
 	
 	flag_type result;
+	bool loaded;
 	
-	size_t bytes;
+	//! Read and decode the bitfield bytes for the flags in the table.
+	void decode() {
+		
+		size_t size = (count + (stored_bits - 1)) / stored_bits;
+		const char * data = is.take(size);
+		bytes += size;
+		
+		// Only look up the flags that are set, bits beyond the declared flags are ignored
+		for(size_t i = 0; i < size; i++) {
+			size_t index = i * stored_bits;
+			for(unsigned bits = boost::uint8_t(data[i]); bits && index < count; bits >>= 1) {
+				if(bits & 1) {
+					result |= table[index];
+				}
+				index++;
+			}
+		}
+		
+		count = 0;
+	}
 	
 public:
 	
-	explicit stored_flag_reader(std::istream & _is, size_t pad_bits = 32)
-		: pad_bits(pad_bits), is(_is), pos(0), result(0), bytes(0) { }
+	explicit stored_flag_reader(util::cursor & _is, size_t pad_bits = 32)
+		: pad_bits(pad_bits), is(_is), count(0), bytes(0), result(0), loaded(false) { }
 	
 	//! Declare the next possible flag.
 	void add(enum_type flag) {
-		
-		if(pos == 0) {
-			bytes++;
-			buffer = util::load<stored_type>(is);
+		if(count == max_flags) {
+			// The table holds a whole number of bytes, so they can be decoded now
+			decode();
 		}
+		table[count++] = flag;
+	}
+	
+	//! Read the bitfield for all declared flags.
+	operator flag_type() {
 		
-		if(buffer & (stored_type(1) << pos)) {
-			result |= flag;
+		if(loaded) {
+			return result;
 		}
+		loaded = true;
 		
-		pos = (pos + 1) % stored_bits;
-	}
-	
-	operator flag_type() const {
+		decode();
 		if(bytes == 3 && pad_bits == 32) {
 			// 3-byte sets are padded to 4 bytes
-			(void)util::load<stored_type>(is);
+			is.skip(1);
 		}
+		
 		return result;
 	}
 	
@@ -251,7 +279,7 @@ class stored_flag_reader<flags<Enum> > : public stored_flag_reader<Enum> {
 	
 public:
 	
-	explicit stored_flag_reader(std::istream & is, size_t pad_bits = 32)
+	explicit stored_flag_reader(util::cursor & is, size_t pad_bits = 32)
 		: stored_flag_reader<Enum>(is, pad_bits) { }
 	
 };
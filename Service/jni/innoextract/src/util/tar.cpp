@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "util/tar.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/static_assert.hpp>
+
+namespace util {
+
+namespace {
+
+const size_t block_size = 512;
+
+const char zero_block[block_size] = { 0 };
+
+struct header {
+	char name[100];
+	char mode[8];
+	char uid[8];
+	char gid[8];
+	char size[12];
+	char mtime[12];
+	char checksum[8];
+	char type;
+	char linkname[100];
+	char magic[6];
+	char version[2];
+	char uname[32];
+	char gname[32];
+	char devmajor[8];
+	char devminor[8];
+	char prefix[155];
+	char padding[12];
+};
+
+BOOST_STATIC_ASSERT(sizeof(header) == block_size);
+
+//! Store a number as a NUL-terminated octal string, returns \c false if it does not fit.
+template <size_t N>
+bool store_octal(char (&field)[N], boost::uint64_t value) {
+	field[N - 1] = '\0';
+	for(size_t i = N - 1; i > 0; i--) {
+		field[i - 1] = char('0' + (value & 7));
+		value >>= 3;
+	}
+	return value == 0;
+}
+
+//! Store a string if it fits into the field, the terminating NUL is optional.
+template <size_t N>
+bool store_string(char (&field)[N], const std::string & value) {
+	if(value.size() > N) {
+		return false;
+	}
+	std::memcpy(field, value.data(), value.size());
+	return true;
+}
+
+//! Store a path in the name and prefix fields of a header.
+bool store_path(header & h, const std::string & path) {
+	
+	if(store_string(h.name, path)) {
+		return true;
+	}
+	
+	// Split the path at a separator so that both parts fit
+	size_t max_prefix = std::min(path.size() - 1, sizeof(h.prefix));
+	size_t pos = path.rfind('/', max_prefix);
+	if(pos != std::string::npos && pos != 0 && path.size() - pos - 1 <= sizeof(h.name)) {
+		store_string(h.prefix, path.substr(0, pos));
+		store_string(h.name, path.substr(pos + 1));
+		return true;
+	}
+	
+	// Store a truncated path for readers without pax support
+	std::memcpy(h.name, path.data(), sizeof(h.name));
+	return false;
+}
+
+//! Create a pax extended header record: "<length> <key>=<value>\n"
+std::string pax_record(const std::string & key, const std::string & value) {
+	
+	size_t base = 1 + key.size() + 1 + value.size() + 1;
+	
+	// The length includes the digits of the length itself
+	size_t length = base + 1;
+	for(;;) {
+		size_t total = base + boost::lexical_cast<std::string>(length).size();
+		if(total == length) {
+			break;
+		}
+		length = total;
+	}
+	
+	return boost::lexical_cast<std::string>(length) + ' ' + key + '=' + value + '\n';
+}
+
+void finalize(header & h) {
+	
+	std::memcpy(h.magic, "ustar", 6);
+	std::memcpy(h.version, "00", 2);
+	
+	std::memset(h.checksum, ' ', sizeof(h.checksum));
+	boost::uint32_t checksum = 0;
+	const unsigned char * bytes = reinterpret_cast<const unsigned char *>(&h);
+	for(size_t i = 0; i < sizeof(h); i++) {
+		checksum += bytes[i];
+	}
+	
+	char field[7];
+	store_octal(field, checksum);
+	std::memcpy(h.checksum, field, sizeof(field));
+}
+
+} // anonymous namespace
+
+tar_writer::tar_writer(std::ostream & os) : os_(os), remaining_(0), size_(0) { }
+
+void tar_writer::write_data(const char * data, size_t size) {
+	if(!os_.write(data, std::streamsize(size))) {
+		throw std::runtime_error("Could not write tar archive");
+	}
+}
+
+void tar_writer::write_padding(boost::uint64_t size) {
+	while(size) {
+		size_t n = size_t(std::min(size, boost::uint64_t(block_size)));
+		write_data(zero_block, n);
+		size -= n;
+	}
+}
+
+void tar_writer::write_header(const std::string & path, char type, boost::uint64_t size,
+                              time mtime, const std::string & target) {
+	
+	header h;
+	std::memset(&h, 0, sizeof(h));
+	
+	std::string pax;
+	
+	if(!store_path(h, path)) {
+		pax += pax_record("path", path);
+	}
+	
+	if(!store_string(h.linkname, target)) {
+		std::memcpy(h.linkname, target.data(), sizeof(h.linkname));
+		pax += pax_record("linkpath", target);
+	}
+	
+	if(!store_octal(h.size, size)) {
+		store_octal(h.size, 0);
+		pax += pax_record("size", boost::lexical_cast<std::string>(size));
+	}
+	
+	if(mtime < 0 || !store_octal(h.mtime, boost::uint64_t(mtime))) {
+		store_octal(h.mtime, 0);
+		pax += pax_record("mtime", boost::lexical_cast<std::string>(mtime));
+	}
+	
+	store_octal(h.mode, type == '5' ? 0755 : 0644);
+	store_octal(h.uid, 0);
+	store_octal(h.gid, 0);
+	h.type = type;
+	
+	if(!pax.empty()) {
+		header x;
+		std::memset(&x, 0, sizeof(x));
+		store_string(x.name, std::string("././@PaxHeader"));
+		store_octal(x.mode, 0644);
+		store_octal(x.uid, 0);
+		store_octal(x.gid, 0);
+		store_octal(x.size, pax.size());
+		std::memcpy(x.mtime, h.mtime, sizeof(x.mtime));
+		x.type = 'x';
+		finalize(x);
+		write_data(reinterpret_cast<const char *>(&x), sizeof(x));
+		write_data(pax.data(), pax.size());
+		write_padding((block_size - pax.size() % block_size) % block_size);
+	}
+	
+	finalize(h);
+	write_data(reinterpret_cast<const char *>(&h), sizeof(h));
+}
+
+void tar_writer::add_directory(const std::string & path, time mtime) {
+	write_header(path + '/', '5', 0, mtime);
+}
+
+void tar_writer::begin_file(const std::string & path, boost::uint64_t size, time mtime) {
+	write_header(path, '0', size, mtime);
+	remaining_ = size_ = size;
+}
+
+void tar_writer::write(const char * data, size_t size) {
+	size = size_t(std::min(boost::uint64_t(size), remaining_));
+	write_data(data, size);
+	remaining_ -= size;
+}
+
+bool tar_writer::end_file() {
+	bool complete = (remaining_ == 0);
+	write_padding(remaining_);
+	write_padding((block_size - size_ % block_size) % block_size);
+	remaining_ = size_ = 0;
+	return complete;
+}
+
+void tar_writer::add_link(const std::string & path, const std::string & target, time mtime) {
+	write_header(path, '1', 0, mtime, target);
+}
+
+void tar_writer::close() {
+	write_padding(2 * block_size);
+	if(!os_.flush()) {
+		throw std::runtime_error("Could not write tar archive");
+	}
+}
+
+} // namespace util
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 Daniel Scharrer
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the author(s) be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*!
+ * \file
+ *
+ * Streaming writer for POSIX tar archives.
+ */
+#ifndef INNOEXTRACT_UTIL_TAR_HPP
+#define INNOEXTRACT_UTIL_TAR_HPP
+
+#include <stddef.h>
+#include <ostream>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "util/time.hpp"
+
+namespace util {
+
+/*!
+ * Write entries to a tar archive without seeking or buffering file contents.
+ *
+ * Headers use the ustar format. Paths, link targets, sizes and timestamps that do not
+ * fit into ustar header fields are stored in an additional pax extended header.
+ *
+ * All write errors are reported with a \c std::runtime_error.
+ */
+class tar_writer : private boost::noncopyable {
+	
+	std::ostream & os_;
+	
+	boost::uint64_t remaining_; //!< Bytes left to write for the current file.
+	boost::uint64_t size_; //!< Size of the current file.
+	
+	void write_header(const std::string & path, char type, boost::uint64_t size, time mtime,
+	                  const std::string & target = std::string());
+	
+	void write_data(const char * data, size_t size);
+	void write_padding(boost::uint64_t size);
+	
+public:
+	
+	explicit tar_writer(std::ostream & os);
+	
+	/*!
+	 * Add a directory entry.
+	 *
+	 * \param path  Path of the directory relative to the archive root.
+	 * \param mtime Modification time of the directory.
+	 */
+	void add_directory(const std::string & path, time mtime);
+	
+	/*!
+	 * Start a new regular file entry.
+	 *
+	 * Exactly \c size bytes of data must be written using \ref write before calling
+	 * \ref end_file.
+	 *
+	 * \param path  Path of the file relative to the archive root.
+	 * \param size  Final size of the file.
+	 * \param mtime Modification time of the file.
+	 */
+	void begin_file(const std::string & path, boost::uint64_t size, time mtime);
+	
+	//! Write data for the current file.
+	void write(const char * data, size_t size);
+	
+	/*!
+	 * Finish the current file.
+	 *
+	 * If less data than announced in \ref begin_file was written, the file is padded
+	 * with zero bytes to keep the archive readable.
+	 *
+	 * \return \c true if the full file contents were written.
+	 */
+	bool end_file();
+	
+	/*!
+	 * Add a hard link to a file that has already been added to the archive.
+	 *
+	 * \param path   Path of the link relative to the archive root.
+	 * \param target Path of the existing file entry.
+	 * \param mtime  Modification time of the link.
+	 */
+	void add_link(const std::string & path, const std::string & target, time mtime);
+	
+	//! Write the end-of-archive marker and flush the output stream.
+	void close();
+	
+};
+
+} // namespace util
+
+#endif // INNOEXTRACT_UTIL_TAR_HPP
@@ -28,6 +28,8 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+
 #if defined(_WIN32)
 #include <windows.h>
 #endif
@@ -48,6 +50,12 @@
 #include <boost/filesystem/operations.hpp>
 #endif
 
+#if INNOEXTRACT_HAVE_FUTIMENS
+#include <sys/stat.h>
+#elif INNOEXTRACT_HAVE_FUTIMES
+#include <sys/time.h>
+#endif
+
 #include "util/log.hpp"
 
 namespace util {
@@ -103,6 +111,26 @@ static void set_timezone(const char * value) {
 	
 }
 
+#if !defined(_WIN32) && !INNOEXTRACT_HAVE_TIMEGM
+
+//! \return the number of days between 1970-01-01 and the given date in the Gregorian calendar.
+static boost::int64_t days_from_civil(boost::int64_t year, int month, int day) {
+	
+	// Count years from March so that the leap day is at the end
+	if(month <= 2) {
+		year--;
+	}
+	boost::int64_t era = (year >= 0 ? year : year - 399) / 400;
+	boost::int64_t year_of_era = year - era * 400;
+	boost::int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	boost::int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100
+	                            + day_of_year;
+	
+	return era * 146097 + day_of_era - 719468;
+}
+
+#endif
+
 time parse_time(std::tm tm) {
 	
 	tm.tm_isdst = 0;
@@ -134,17 +162,18 @@ time parse_time(std::tm tm) {
 	
 #else
 	
-	// Standard, but not thread-safe - should be OK for our use though
-	
-	char * tz = getenv("TZ");
+	// Portable and thread-safe, unlike changing the timezone for std::mktime
 	
-	set_timezone("UTC");
+	// Out-of-range months carry over into the year, other fields are added as-is
+	boost::int64_t year = boost::int64_t(tm.tm_year) + 1900 + tm.tm_mon / 12;
+	int month = tm.tm_mon % 12;
+	if(month < 0) {
+		month += 12, year--;
+	}
 	
-	time ret = std::mktime(&tm);
+	boost::int64_t days = days_from_civil(year, month + 1, 1) + tm.tm_mday - 1;
 	
-	set_timezone(tz);
-	
-	return ret;
+	return ((days * 24 + tm.tm_hour) * 60 + tm.tm_min) * 60 + tm.tm_sec;
 	
 #endif
 	
@@ -223,6 +252,65 @@ time to_local_time(time t) {
 	return std::mktime(&time);
 }
 
+static const time seconds_per_day = 24 * 60 * 60;
+
+//! Only prepare this many days up front, convert lazily outside that range.
+static const time max_prepared_days = 10 * 366;
+
+static time day_index(time t) {
+	return (t >= 0) ? t / seconds_per_day : -((-t - 1) / seconds_per_day) - 1;
+}
+
+const local_time_converter::day & local_time_converter::get_day(time index) {
+	
+	std::pair<day_map::iterator, bool> entry = days.insert(std::make_pair(index, day()));
+	day & result = entry.first->second;
+	if(!entry.second) {
+		return result;
+	}
+	
+	time begin = index * seconds_per_day;
+	time end = begin + seconds_per_day - 1;
+	
+	result.before = begin - to_local_time(begin);
+	result.after = end - to_local_time(end);
+	result.transition = end + 1;
+	
+	if(result.before != result.after) {
+		// Find the first timestamp that uses the new offset
+		time low = begin, high = end;
+		while(high - low > 1) {
+			time mid = low + (high - low) / 2;
+			if(mid - to_local_time(mid) == result.before) {
+				low = mid;
+			} else {
+				high = mid;
+			}
+		}
+		result.transition = high;
+	}
+	
+	return result;
+}
+
+void local_time_converter::prepare(time begin, time end) {
+	
+	if(end < begin) {
+		return;
+	}
+	
+	time first = day_index(begin);
+	time last = std::min(day_index(end), first + max_prepared_days);
+	for(time i = first; i <= last; i++) {
+		get_day(i);
+	}
+}
+
+time local_time_converter::convert(time t) {
+	const day & d = get_day(day_index(t));
+	return t - ((t < d.transition) ? d.before : d.after);
+}
+
 void set_local_timezone(std::string timezone) {
 	
 	/*
@@ -333,4 +421,40 @@ bool set_file_time(const boost::filesystem::path & path, time t, boost::uint32_t
 	
 }
 
+bool set_file_time(file_handle handle, time t, boost::uint32_t nsec) {
+	
+#if defined(_WIN32)
+	
+	FILETIME filetime = to_filetime(t, nsec);
+	
+	return (SetFileTime(handle, &filetime, &filetime, &filetime) != 0);
+	
+#elif INNOEXTRACT_HAVE_FUTIMENS
+	
+	struct timespec timens[2];
+	timens[0].tv_sec = to_time_t<time_t>(t);
+	timens[0].tv_nsec = boost::int32_t(nsec);
+	timens[1] = timens[0];
+	
+	return (futimens(handle, timens) == 0);
+	
+#elif INNOEXTRACT_HAVE_FUTIMES
+	
+	struct timeval times[2];
+	times[0].tv_sec = to_time_t<time_t>(t);
+	times[0].tv_usec = boost::int32_t(nsec / 1000);
+	times[1] = times[0];
+	
+	return (futimes(handle, times) == 0);
+	
+#else
+	
+	// Not supported - the caller will fall back to setting the time by path
+	(void)handle, (void)t, (void)nsec;
+	return false;
+	
+#endif
+	
+}
+
 } // namespace util
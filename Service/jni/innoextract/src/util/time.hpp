@@ -31,6 +31,9 @@
 
 #include <boost/cstdint.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "util/file.hpp"
 
 namespace util {
 
@@ -39,7 +42,7 @@ typedef boost::int64_t time;
 /*!
  * Convert UTC clock time to a timestamp
  *
- * \note This function may not be thread-safe on all operating systems.
+ * This function is thread-safe.
  */
 time parse_time(std::tm tm);
 
@@ -57,6 +60,46 @@ std::tm format_time(time t);
  */
 time to_local_time(time t);
 
+/*!
+ * Cached version of \ref to_local_time for converting many timestamps.
+ *
+ * The offset between UTC and local time is resolved once for each day that contains
+ * a converted timestamp. Daylight saving time transitions inside a day are located
+ * exactly, so the results are identical to those of \ref to_local_time.
+ *
+ * \note This class is not thread-safe.
+ */
+class local_time_converter {
+	
+	struct day {
+		time transition; //!< First timestamp that uses the \c after offset.
+		time before;     //!< Offset before the transition.
+		time after;      //!< Offset starting at the transition.
+	};
+	
+	typedef boost::unordered_map<time, day> day_map;
+	day_map days;
+	
+	const day & get_day(time index);
+	
+public:
+	
+	/*!
+	 * Resolve the UTC offsets for a range of timestamps.
+	 *
+	 * This is only an optimization - timestamps outside the prepared range are
+	 * still converted correctly.
+	 *
+	 * \param begin The first timestamp that will be converted.
+	 * \param end   The last timestamp that will be converted.
+	 */
+	void prepare(time begin, time end);
+	
+	//! Convert a timestamp to local time, see \ref to_local_time.
+	time convert(time t);
+	
+};
+
 /*!
  * Set the local timezone used by to_local_time
  *
@@ -82,6 +125,22 @@ void set_local_timezone(std::string timezone);
  */
 bool set_file_time(const boost::filesystem::path & path, time sec, boost::uint32_t nsec);
 
+/*!
+ * Set an open file's access, creation and modification times.
+ *
+ * Any buffered data must be written to the file before calling this function as writes
+ * will update the modification time again.
+ *
+ * \param handle The native handle of a file that has been opened for writing.
+ * \param sec    File time to set (in seconds).
+ * \param nsec   Sub-second component of the file time to set (in nanoseconds).
+ *
+ * \return \c true if the file time was changed, \c false otherwise or if the operating
+ *         system does not support changing the times of open files. Use the path-based
+ *         overload after closing the file in that case.
+ */
+bool set_file_time(file_handle handle, time sec, boost::uint32_t nsec);
+
 } // namespace util
 
 #endif // INNOEXTRACT_UTIL_TIME_HPP